@@ -241,6 +241,10 @@ extern int lexor_keyword_mask;
   /* This is the string to use to invoke the preprocessor. */
 extern char*ivlpp_string;
 
+  /* If not nil, this is the directory where the preprocessed text of
+     library module files is cached between runs. */
+extern char*parse_cache_dir;
+
 extern map<perm_string,unsigned> missing_modules;
 
   /* Files that are library files are in this map. The lexor compares
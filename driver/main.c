@@ -1336,6 +1336,11 @@ int main(int argc, char **argv)
               defines_path, compiled_defines_path
       );
 
+	/* If the user named a parse cache directory, pass it on so
+	   that the preprocessed library files can be reused. */
+      if (getenv("IVERILOG_PARSE_CACHE"))
+	    fprintf(iconfig_file, "parse_cache:%s\n", getenv("IVERILOG_PARSE_CACHE"));
+
 	/* Done writing to the iconfig file. Close it now. */
       fclose(iconfig_file);
 
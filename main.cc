@@ -675,6 +675,10 @@ static void read_iconfig_file(const char*ipath)
 	    } else if (strcmp(buf, "ivlpp") == 0) {
 		  ivlpp_string = strdup(cp);
 
+	    } else if (strcmp(buf, "parse_cache") == 0) {
+		  free(parse_cache_dir);
+		  parse_cache_dir = strdup(cp);
+
 	    } else if (strcmp(buf, "iwidth") == 0) {
 		  integer_width = strtoul(cp,0,10);
 
@@ -852,6 +856,7 @@ static void EOC_cleanup(void)
 
       free((void *) basedir);
       free(ivlpp_string);
+      free(parse_cache_dir);
       free(depfile_name);
 
       for (map<string, const char*>::iterator flg = flags.begin() ;
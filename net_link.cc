@@ -29,6 +29,54 @@
 # include  <cstdlib>
 # include  "ivl_alloc.h"
 
+/*
+ * Move all the links of that nexus into this nexus and delete that
+ * nexus. Only the links of that nexus need their nexus_ pointer
+ * changed, so callers should absorb the smaller nexus into the larger
+ * one. The that_first flag puts the links of that nexus before the
+ * links of this nexus in the list, so the list order can be kept the
+ * same whichever nexus survives.
+ */
+void Nexus::absorb_(Nexus*that, bool that_first)
+{
+      assert(list_ && that->list_);
+
+      delete[] name_;
+      name_ = 0;
+
+      Nexus*second = that_first? this : that;
+      Nexus*first = that_first? that : this;
+      if (second->driven_ != Vz)
+	    driven_ = NO_GUESS;
+      else
+	    driven_ = first->driven_;
+
+      Link*that_last = that->list_;
+      Link*cur = that_last;
+      do {
+	    cur->nexus_ = this;
+	    cur = cur->next_;
+      } while (cur != that_last);
+
+	// Splice the circle of links of the second nexus after the
+	// last link of the first, and make the last link of the
+	// second the end of the list.
+      Link*first_last = first->list_;
+      Link*second_last = second->list_;
+      Link*first_head = first_last->next_;
+      Link*second_head = second_last->next_;
+      first_last->next_ = second_head;
+      second_head->prev_ = first_last;
+      second_last->next_ = first_head;
+      first_head->prev_ = second_last;
+      list_ = second_last;
+      nlinks_ += that->nlinks_;
+
+      that->list_ = 0;
+      that->nlinks_ = 0;
+      delete that;
+}
+
 void Nexus::connect(Link&r)
 {
       Nexus*r_nexus = r.next_? r.find_nexus_() : 0;
@@ -45,47 +93,45 @@ void Nexus::connect(Link&r)
 	    if (r.next_ == 0) {
 		  list_ = &r;
 		  r.next_ = &r;
+		  r.prev_ = &r;
 		  r.nexus_ = this;
+		  nlinks_ = 1;
 		  driven_ = NO_GUESS;
 	    } else {
+		  Link*cur = r_nexus->list_;
+		  do {
+			cur->nexus_ = this;
+			cur = cur->next_;
+		  } while (cur != r_nexus->list_);
 		  driven_ = r_nexus->driven_;
 		  list_ = r_nexus->list_;
-		  list_->nexus_ = this;
+		  nlinks_ = r_nexus->nlinks_;
 		  r_nexus->list_ = 0;
+		  r_nexus->nlinks_ = 0;
 		  delete r_nexus;
 	    }
 	    return;
       }
 
 	// Special case: The Link is unconnected. Put it at the end of
-	// the current list and move the list_ pointer and nexus_ back
-	// pointer to suit.
+	// the current list and move the list_ pointer to suit.
       if (r.next_ == 0) {
 	    if (r.get_dir() != Link::INPUT)
 		  driven_ = NO_GUESS;
 
 	    r.nexus_ = this;
 	    r.next_ = list_->next_;
+	    r.prev_ = list_;
+	    list_->next_->prev_ = &r;
 	    list_->next_ = &r;
-	    list_->nexus_ = 0;
 	    list_ = &r;
+	    nlinks_ += 1;
 	    return;
       }
 
-      if (r_nexus->driven_ != Vz)
-	    driven_ = NO_GUESS;
-
-	// Splice the list of links from the "tmp" nexus to the end of
-	// this nexus. Adjust the nexus pointers as needed.
-      Link*save_first = list_->next_;
-      list_->next_ = r_nexus->list_->next_;
-      r_nexus->list_->next_ = save_first;
-      list_->nexus_ = 0;
-      list_ = r_nexus->list_;
-      list_->nexus_ = this;
-
-      r_nexus->list_ = 0;
-      delete r_nexus;
+	// Splice the list of links from the r nexus to the end of
+	// this nexus.
+      absorb_(r_nexus, false);
 }
 
 void connect(Link&l, Link&r)
@@ -94,11 +140,21 @@ void connect(Link&l, Link&r)
       assert(&l != &r);
 	// If either the l or r link already are part of a Nexus, then
 	// re-use that nexus. Go through some effort so that we are
-	// not gratuitously creating Nexus object.
-      if (l.next_ && (tmp=l.find_nexus_())) {
-	    connect(tmp, r);
-      } else if (r.next_ && (tmp=r.find_nexus_())) {
-	    connect(tmp, l);
+	// not gratuitously creating Nexus object. If both are, keep
+	// the larger nexus so that the fewest links need to be moved.
+      Nexus*l_nexus = l.next_? l.find_nexus_() : 0;
+      Nexus*r_nexus = r.next_? r.find_nexus_() : 0;
+      if (l_nexus && r_nexus) {
+	    if (l_nexus == r_nexus)
+		  return;
+	    if (l_nexus->nlinks_ >= r_nexus->nlinks_)
+		  l_nexus->absorb_(r_nexus, false);
+	    else
+		  r_nexus->absorb_(l_nexus, true);
+      } else if (l_nexus) {
+	    connect(l_nexus, r);
+      } else if (r_nexus) {
+	    connect(r_nexus, l);
       } else {
 	      // No existing Nexus (both links are so far unconnected)
 	      // so start one.
@@ -109,7 +165,7 @@ void connect(Link&l, Link&r)
 
 Link::Link()
 : dir_(PASSIVE), drive0_(IVL_DR_STRONG), drive1_(IVL_DR_STRONG),
-  next_(0), nexus_(0)
+  next_(0), prev_(0), nexus_(0)
 {
       node_ = 0;
       pin_zero_ = true;
@@ -128,11 +184,7 @@ Link::~Link()
 Nexus* Link::find_nexus_() const
 {
       assert(next_);
-      if (nexus_) return nexus_;
-      for (Link*cur = next_ ; cur != this ; cur = cur->next_) {
-	    if (cur->nexus_) return cur->nexus_;
-      }
-      return 0;
+      return nexus_;
 }
 
 Nexus* Link::nexus()
@@ -237,13 +289,10 @@ bool Link::is_linked(const Link&that) const
       if (! that.is_linked())
 	    return false;
 
-      const Link*cur = next_;
-      while (cur != this) {
-	    if (cur == &that) return true;
-	    cur = cur->next_;
-      }
+      if (&that == this)
+	    return false;
 
-      return false;
+      return nexus_ == that.nexus_;
 }
 
 Nexus::Nexus(Link&that)
@@ -254,18 +303,26 @@ Nexus::Nexus(Link&that)
 
       if (that.next_ == 0) {
 	    list_ = &that;
+	    nlinks_ = 1;
 	    that.next_ = &that;
+	    that.prev_ = &that;
 	    that.nexus_ = this;
 	    driven_ = NO_GUESS;
 
       } else {
 	    Nexus*tmp = that.find_nexus_();
 	    list_ = tmp->list_;
-	    list_->nexus_ = this;
+	    nlinks_ = tmp->nlinks_;
+	    Link*cur = list_;
+	    do {
+		  cur->nexus_ = this;
+		  cur = cur->next_;
+	    } while (cur != list_);
 	    driven_ = tmp->driven_;
 	    name_ = tmp->name_;
 
 	    tmp->list_ = 0;
+	    tmp->nlinks_ = 0;
 	    tmp->name_ = 0;
 	    delete tmp;
       }
@@ -397,9 +454,11 @@ void Nexus::unlink(Link*that)
 	    assert(that->nexus_ == this);
 	    assert(list_ == that);
 	    list_ = 0;
+	    nlinks_ = 0;
 	    driven_ = NO_GUESS;
 	    that->nexus_ = 0;
 	    that->next_ = 0;
+	    that->prev_ = 0;
 	    return;
       }
 
@@ -408,25 +467,21 @@ void Nexus::unlink(Link*that)
       if (that->get_dir() != Link::INPUT)
 	    driven_ = NO_GUESS;
 
-	// Look for the Link that points to "that". We know that there
-	// will be one because the list is a circle. When we find the
-	// prev pointer, then remove that from the list.
-      Link*prev = list_;
-      while (prev->next_ != that)
-	    prev = prev->next_;
-
+	// Remove "that" from the circle.
+      assert(that->nexus_ == this);
+      Link*prev = that->prev_;
       prev->next_ = that->next_;
+      that->next_->prev_ = prev;
+      nlinks_ -= 1;
 
 	// If "that" was the last item in the list, then change the
 	// list_ pointer to point to the new end of the list.
-      if (list_ == that) {
-	    assert(that->nexus_ == this);
+      if (list_ == that)
 	    list_ = prev;
-	    list_->nexus_ = this;
-      }
 
       that->nexus_ = 0;
       that->next_ = 0;
+      that->prev_ = 0;
 }
 
 Link* Nexus::first_nlink()
@@ -443,18 +498,12 @@ const Link* Nexus::first_nlink() const
 
 /*
  * The t_cookie can be set exactly once. This attaches an ivl_nexus_t
- * object to the Nexus, and causes the Link list to be marked up for
- * efficient use by the code generator. The change is to give all the
- * links a valid nexus_ pointer. This breaks most of the other
- * methods, but they are not used during code generation.
+ * object to the Nexus for use by the code generator.
 */
 void Nexus::t_cookie(ivl_nexus_t val) const
 {
       assert(val && !t_cookie_);
       t_cookie_ = val;
-
-      for (Link*cur = list_->next_ ; cur->nexus_ == 0 ; cur = cur->next_)
-	    cur->nexus_ = const_cast<Nexus*> (this);
 }
 
 unsigned Nexus::vector_width() const
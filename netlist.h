@@ -189,9 +189,13 @@ class Link {
 
     private:
 	// The Nexus uses these to maintain its list of Link
-	// objects. If this link is not connected to anything,
-	// then these pointers are both nil.
+	// objects. The list is a doubly linked circle, and every
+	// Link in it points directly to the Nexus, so that finding
+	// the nexus and unlinking are constant time. If this link
+	// is not connected to anything, then these pointers are
+	// all nil.
       Link *next_;
+      Link *prev_;
       Nexus*nexus_;
 
     private: // not implemented
@@ -419,8 +423,12 @@ class Nexus {
       void t_cookie(ivl_nexus_t) const;
 
     private:
+	// The list_ points to the last Link in the circle of links,
+	// and nlinks_ counts them.
       Link*list_;
+      unsigned nlinks_;
       void unlink(Link*);
+      void absorb_(Nexus*that, bool that_first);
 
       mutable char* name_; /* Cache the calculated name for the Nexus. */
       mutable ivl_nexus_t t_cookie_;
@@ -5105,18 +5113,18 @@ inline __ObjectPathManip scope_path(const NetObj*obj)
 extern ostream& operator << (ostream&o, __ObjectPathManip);
 
 /*
- * If this link has a nexus_ pointer, then it is the last Link in the
- * list. next_nlink() returns 0 for the last Link.
+ * The last Link in the list is the one that the Nexus list_ points
+ * to. next_nlink() returns 0 for the last Link.
  */
 inline Link* Link::next_nlink()
 {
-      if (nexus_) return 0;
+      if (nexus_ == 0 || nexus_->list_ == this) return 0;
       else return next_;
 }
 
 inline const Link* Link::next_nlink() const
 {
-      if (nexus_) return 0;
+      if (nexus_ == 0 || nexus_->list_ == this) return 0;
       else return next_;
 }
 
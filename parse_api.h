@@ -58,6 +58,14 @@ extern void pform_dump(std::ostream&out, const PTaskFunc*tf);
  */
 extern int pform_parse(const char*path);
 
+/*
+ * Open the preprocessed text of the file from the parse cache,
+ * preprocessing it into the cache first if needed. This is only used
+ * if the parse_cache_dir and ivlpp_string variables are set. Return
+ * nil if the cache can not be used for this file.
+ */
+extern FILE* parse_cache_open(const char*path);
+
 extern string vl_file;
 
 extern void pform_set_timescale(int units, int prec, const char*file,
@@ -0,0 +1,441 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "config.h"
+# include  "compiler.h"
+# include  "parse_api.h"
+# include  <iostream>
+# include  <cstdio>
+# include  <cstdlib>
+# include  <cassert>
+# include  <cctype>
+# include  <cstring>
+# include  <string>
+# include  <list>
+# include  <set>
+# include  <stdint.h>
+# include  <sys/types.h>
+# include  <sys/stat.h>
+# include  <unistd.h>
+
+/*
+ * Library module files that are loaded from a library directory are
+ * each run through the preprocessor in a separate process before they
+ * are parsed. Most of these files do not change from one run to the
+ * next, so the preprocessed text is saved in the parse cache directory
+ * and reused by later runs.
+ *
+ * A cache entry is named by a hash of everything that goes into the
+ * preprocessor command: the command itself, with the contents of the
+ * defines files in place of their (temporary) names, the path of the
+ * source file and its contents.
+ *
+ * The entry is a single file, <hash>.v, that starts with a header and
+ * is followed by the preprocessed text. The header has these lines,
+ * and ends with an empty line:
+ *
+ *    F <hash> <path>
+ *	A file that was included, with a hash of its contents.
+ *
+ *    A <path>
+ *	A path that the include search tried before it found one of the
+ *	included files. The path did not exist, and if it is created
+ *	later it will shadow the file that was used.
+ *
+ * The entry is only used if every included file still has the same
+ * contents and none of the shadowing paths exist. New entries are
+ * written to a file with a name unique to this process and renamed
+ * into place, so runs that share the cache directory see either the
+ * complete entry or none at all.
+ */
+
+char*parse_cache_dir = 0;
+
+static const uint64_t FNV_OFFSET = 0xcbf29ce484222325ULL;
+static const uint64_t FNV_PRIME  = 0x100000001b3ULL;
+
+/*
+ * These are the preprocessor settings, read from its flags files, that
+ * the cache needs to know about.
+ */
+struct include_search_s {
+      include_search_s() : relative(false), depend(false) { dirs.push_back("."); }
+	// The include directories, in the order they are searched.
+      list<string> dirs;
+	// True if the directory of the including file is searched first.
+      bool relative;
+	// True if the preprocessor writes a dependency file.
+      bool depend;
+};
+
+static void hash_bytes(uint64_t&hash, const char*data, size_t len)
+{
+      for (size_t idx = 0 ;  idx < len ;  idx += 1) {
+	    hash ^= (unsigned char)data[idx];
+	    hash *= FNV_PRIME;
+      }
+}
+
+/*
+ * Hash the contents of the file, and return false if the file can not
+ * be read.
+ */
+static bool hash_file(uint64_t&hash, const char*path)
+{
+      FILE*fd = fopen(path, "rb");
+      if (fd == 0)
+	    return false;
+
+      char buf[8192];
+      size_t cnt;
+      while ((cnt = fread(buf, 1, sizeof buf, fd)) > 0)
+	    hash_bytes(hash, buf, cnt);
+
+      fclose(fd);
+      return true;
+}
+
+static string hash_string(uint64_t hash)
+{
+      char buf[32];
+      snprintf(buf, sizeof buf, "%08lx%08lx",
+	       (unsigned long)(hash >> 32), (unsigned long)(hash & 0xffffffffUL));
+      return buf;
+}
+
+/*
+ * Read the settings from a preprocessor flags (-F) file. The format is
+ * the one that ivlpp reads in flist_read_flags.
+ */
+static bool read_flags(const char*path, include_search_s&search)
+{
+      FILE*fd = fopen(path, "r");
+      if (fd == 0)
+	    return false;
+
+      char buf[4096];
+      while (fgets(buf, sizeof buf, fd) != 0) {
+	    char*cp = buf + strspn(buf, " \t\r\b\f");
+	    char*tail = cp + strlen(cp);
+	    while (tail > cp && isspace((int)tail[-1])) {
+		  tail -= 1;
+		  tail[0] = 0;
+	    }
+
+	    char*arg = strchr(cp, ':');
+	    if (arg == 0)
+		  continue;
+	    *arg++ = 0;
+
+	    if (strcmp(cp, "I") == 0)
+		  search.dirs.push_back(arg);
+	    else if (strcmp(cp, "relative include") == 0)
+		  search.relative = strcmp(arg, "true") == 0;
+	    else if (cp[0] == 'M' && cp[1] != 0 && cp[2] == 0)
+		  search.depend = true;
+      }
+
+      fclose(fd);
+      return true;
+}
+
+/*
+ * The preprocessor command names its defines files with -F"path" and
+ * -P"path" arguments. These are temporary files that have a new name
+ * for every run, so hash their contents instead of their names.
+ */
+static bool hash_command(uint64_t&hash, const char*cmd, include_search_s&search)
+{
+      const char*cp = cmd;
+      while (*cp) {
+	    if (cp[0] == '-' && (cp[1] == 'F' || cp[1] == 'P') && cp[2] == '"') {
+		  const char*end = strchr(cp+3, '"');
+		  if (end == 0)
+			return false;
+
+		  string name (cp+3, end-cp-3);
+		  hash_bytes(hash, cp, 2);
+		  if (! hash_file(hash, name.c_str()))
+			return false;
+		  if (cp[1] == 'F' && ! read_flags(name.c_str(), search))
+			return false;
+		  cp = end + 1;
+		  continue;
+	    }
+
+	    hash_bytes(hash, cp, 1);
+	    cp += 1;
+      }
+      return true;
+}
+
+/*
+ * Read the header of a cache entry, and return true if the entry is
+ * still good. The file is left positioned at the preprocessed text.
+ */
+static bool check_entry(FILE*fd)
+{
+      char buf[4096];
+      while (fgets(buf, sizeof buf, fd) != 0) {
+	    size_t len = strcspn(buf, "\r\n");
+	    if (buf[len] == 0)
+		  return false;
+	    buf[len] = 0;
+
+	    if (len == 0)
+		  return true;
+
+	    if (strncmp(buf, "A ", 2) == 0) {
+		  struct stat sb;
+		  if (stat(buf+2, &sb) == 0)
+			return false;
+		  continue;
+	    }
+
+	    if (strncmp(buf, "F ", 2) != 0 || len < 19 || buf[18] != ' ')
+		  return false;
+
+	    uint64_t hash = FNV_OFFSET;
+	    if (! hash_file(hash, buf+19))
+		  return false;
+	    if (hash_string(hash).compare(0, 16, buf+2, 16) != 0)
+		  return false;
+      }
+
+      return false;
+}
+
+static string dir_of(const string&path)
+{
+      size_t pos = path.rfind('/');
+      if (pos == string::npos)
+	    return "";
+      return path.substr(0, pos);
+}
+
+/*
+ * The preprocessor found the include file by trying each directory of
+ * the search in turn. Work out which directory it was, from the path
+ * it was found at, and add the paths of the same name in the earlier
+ * directories to the shadow set. The directory of the including file
+ * is not known here, so if relative includes are on, the directories
+ * of all the files read are treated as earlier. That only adds paths,
+ * and paths that exist now could not have been tried, so they are left
+ * out.
+ */
+static void add_shadow_paths(set<string>&shadow, const string&found,
+			     const set<string>&rel_dirs,
+			     const include_search_s&search)
+{
+      if (found.empty() || found[0] == '/')
+	    return;
+
+      list<string> earlier;
+      if (search.relative)
+	    earlier.insert(earlier.end(), rel_dirs.begin(), rel_dirs.end());
+
+      for (list<string>::const_iterator dir = search.dirs.begin()
+		 ; dir != search.dirs.end() ; ++ dir ) {
+	    string prefix = *dir + "/";
+	    if (found.compare(0, prefix.size(), prefix) == 0) {
+		  string name = found.substr(prefix.size());
+		  for (list<string>::const_iterator cur = earlier.begin()
+			     ; cur != earlier.end() ; ++ cur ) {
+			string path = *cur + "/" + name;
+			struct stat sb;
+			if (path != found && stat(path.c_str(), &sb) != 0)
+			      shadow.insert(path);
+		  }
+	    }
+	    earlier.push_back(*dir);
+      }
+}
+
+/*
+ * Write the complete cache entry to entry_path. The included files are
+ * listed in the dependency file that the preprocessor wrote, in the
+ * order that it found them.
+ */
+static bool write_entry(const string&entry_path, const string&text_path,
+			const string&dep_path, const char*src_path,
+			const include_search_s&search)
+{
+      list<string> files;
+      FILE*fd = fopen(dep_path.c_str(), "r");
+      if (fd == 0)
+	    return false;
+
+      char buf[8192];
+      while (fgets(buf, sizeof buf, fd) != 0) {
+	    buf[strcspn(buf, "\r\n")] = 0;
+	    if (buf[0] != 0)
+		  files.push_back(buf);
+      }
+      fclose(fd);
+
+      set<string> rel_dirs;
+      if (! dir_of(src_path).empty())
+	    rel_dirs.insert(dir_of(src_path));
+      for (list<string>::const_iterator cur = files.begin()
+		 ; cur != files.end() ; ++ cur ) {
+	    string dir = dir_of(*cur);
+	    if (! dir.empty())
+		  rel_dirs.insert(dir);
+      }
+
+      set<string> shadow;
+      for (list<string>::const_iterator cur = files.begin()
+		 ; cur != files.end() ; ++ cur )
+	    add_shadow_paths(shadow, *cur, rel_dirs, search);
+
+      FILE*text = fopen(text_path.c_str(), "rb");
+      if (text == 0)
+	    return false;
+
+      fd = fopen(entry_path.c_str(), "wb");
+      if (fd == 0) {
+	    fclose(text);
+	    return false;
+      }
+
+      bool flag = true;
+      set<string> done;
+      for (list<string>::const_iterator cur = files.begin()
+		 ; flag && cur != files.end() ; ++ cur ) {
+	    if (! done.insert(*cur).second)
+		  continue;
+	    uint64_t hash = FNV_OFFSET;
+	    if (hash_file(hash, cur->c_str()))
+		  fprintf(fd, "F %s %s\n", hash_string(hash).c_str(), cur->c_str());
+	    else
+		  flag = false;
+      }
+      for (set<string>::const_iterator cur = shadow.begin()
+		 ; cur != shadow.end() ; ++ cur )
+	    fprintf(fd, "A %s\n", cur->c_str());
+      fputc('\n', fd);
+
+      size_t cnt;
+      while ((cnt = fread(buf, 1, sizeof buf, text)) > 0) {
+	    if (fwrite(buf, 1, cnt, fd) != cnt)
+		  flag = false;
+      }
+
+      fclose(text);
+      if (fclose(fd) != 0)
+	    flag = false;
+
+      return flag;
+}
+
+/*
+ * Rename the finished entry into place. Some systems will not rename
+ * over an existing file, so on failure remove the old entry and try
+ * once more.
+ */
+static bool publish_entry(const string&tmp_path, const string&entry_path)
+{
+      if (rename(tmp_path.c_str(), entry_path.c_str()) == 0)
+	    return true;
+
+      remove(entry_path.c_str());
+      return rename(tmp_path.c_str(), entry_path.c_str()) == 0;
+}
+
+FILE* parse_cache_open(const char*path)
+{
+      assert(parse_cache_dir && ivlpp_string);
+
+      uint64_t hash = FNV_OFFSET;
+      include_search_s search;
+      if (! hash_command(hash, ivlpp_string, search))
+	    return 0;
+
+	/* The preprocessor adds every file it reads to the user's
+	   dependency file, so it must run every time. */
+      if (search.depend)
+	    return 0;
+
+      hash_bytes(hash, "", 1);
+      hash_bytes(hash, path, strlen(path)+1);
+      if (! hash_file(hash, path))
+	    return 0;
+
+      string entry_path = string(parse_cache_dir) + "/" + hash_string(hash) + ".v";
+
+      FILE*fd = fopen(entry_path.c_str(), "rb");
+      if (fd) {
+	    if (check_entry(fd)) {
+		  if (verbose_flag)
+			cerr << "Using cached " << entry_path
+			     << " for " << path << "." << endl;
+		  return fd;
+	    }
+	    fclose(fd);
+      }
+
+	/* There is no usable entry, so run the preprocessor into a
+	   new one. It writes the list of included files to a
+	   dependency file named by an extra flags file. */
+      char tmp_tail[32];
+      snprintf(tmp_tail, sizeof tmp_tail, ".%ld", (long)getpid());
+      string tmp_base = entry_path + tmp_tail;
+      string text_path = tmp_base + ".txt";
+      string dep_path = tmp_base + ".dep";
+      string flags_path = tmp_base + ".flags";
+      string tmp_path = tmp_base + ".tmp";
+
+      fd = fopen(flags_path.c_str(), "w");
+      if (fd == 0)
+	    return 0;
+      fprintf(fd, "Mi:%s\n", dep_path.c_str());
+      fclose(fd);
+	/* The file is opened for append, so start with none. */
+      remove(dep_path.c_str());
+
+      string cmdline = string(ivlpp_string) + " -F\"" + flags_path + "\" \""
+	    + path + "\" > \"" + text_path + "\"";
+
+      if (verbose_flag)
+	    cerr << "Executing: " << cmdline << endl << flush;
+
+      int rc = system(cmdline.c_str());
+      remove(flags_path.c_str());
+
+	/* If the preprocessor failed, parse what it wrote (as the
+	   pipe would have) but do not keep it in the cache. */
+      if (rc != 0 || ! write_entry(tmp_path, text_path, dep_path, path, search)
+	  || ! publish_entry(tmp_path, entry_path)) {
+	    fd = fopen(text_path.c_str(), "r");
+	    remove(text_path.c_str());
+	    remove(dep_path.c_str());
+	    remove(tmp_path.c_str());
+	    return fd;
+      }
+
+      remove(text_path.c_str());
+      remove(dep_path.c_str());
+
+      fd = fopen(entry_path.c_str(), "rb");
+      if (fd && ! check_entry(fd)) {
+	    fclose(fd);
+	    fd = 0;
+      }
+      return fd;
+}
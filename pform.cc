@@ -3659,8 +3659,13 @@ extern void reset_lexor();
 int pform_parse(const char*path)
 {
       vl_file = path;
+      bool vl_input_pipe = false;
       if (strcmp(path, "-") == 0) {
 	    vl_input = stdin;
+      } else if (ivlpp_string && parse_cache_dir
+		 && (vl_input = parse_cache_open(path)) != 0) {
+	    if (verbose_flag)
+		  cerr << "...parsing cached preprocessor output..." << endl << flush;
       } else if (ivlpp_string) {
 	    char*cmdline = (char*)malloc(strlen(ivlpp_string) +
 					        strlen(path) + 4);
@@ -3677,6 +3682,7 @@ int pform_parse(const char*path)
 		  cerr << "Unable to preprocess " << path << "." << endl;
 		  return 1;
 	    }
+	    vl_input_pipe = true;
 
 	    if (verbose_flag)
 		  cerr << "...parsing output from preprocessor..." << endl << flush;
@@ -3717,7 +3723,7 @@ int pform_parse(const char*path)
       int rc = VLparse();
 
       if (vl_input != stdin) {
-	    if (ivlpp_string)
+	    if (vl_input_pipe)
 		  pclose(vl_input);
 	    else
 		  fclose(vl_input);
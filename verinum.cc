@@ -24,6 +24,7 @@
 # include  <cassert>
 # include  <cmath> // Needed to get pow for as_double().
 # include  <cstdio> // Needed to get snprintf for as_string().
+# include  <cstring>
 # include  <algorithm>
 
 #if !defined(HAVE_LROUND)
@@ -43,21 +44,174 @@ extern "C" long int lround(double x)
 
 static verinum::V add_with_carry(verinum::V l, verinum::V r, verinum::V&c);
 
+const unsigned verinum::BITS_PER_WORD;
+
+static const unsigned BPW = verinum::BITS_PER_WORD;
+
+/*
+ * The bits of the two planes for each of the V values, and the V value
+ * for each a/b pair (indexed by a | b<<1).
+ */
+static const verinum::V bits_to_v[4] = {
+      verinum::V0, verinum::V1, verinum::Vz, verinum::Vx
+};
+
+static inline bool v_abit(verinum::V val)
+{ return val == verinum::V1 || val == verinum::Vx; }
+
+static inline bool v_bbit(verinum::V val)
+{ return val == verinum::Vx || val == verinum::Vz; }
+
+static inline unsigned words_for(unsigned nbits)
+{ return (nbits + BPW - 1) / BPW; }
+
+/*
+ * Return the mask of the used bits in the top word of an nbits wide
+ * plane.
+ */
+static inline unsigned long top_word_mask(unsigned nbits)
+{
+      unsigned tail = nbits % BPW;
+      return tail? (1UL << tail) - 1UL : ~0UL;
+}
+
+static inline bool word_bit(const unsigned long*words, unsigned idx)
+{ return (words[idx/BPW] >> (idx%BPW)) & 1UL; }
+
+/*
+ * Get word w of the nbits wide plane, extended past the top with
+ * zeros or, if the pad flag is set, ones.
+ */
+static inline unsigned long ext_word(const unsigned long*words, unsigned nbits,
+				     unsigned w, bool pad)
+{
+      unsigned nw = words_for(nbits);
+      if (w >= nw)
+	    return pad? ~0UL : 0UL;
+
+      unsigned long word = words[w];
+      if (pad && w == nw-1)
+	    word |= ~top_word_mask(nbits);
+      return word;
+}
+
+/*
+ * Copy n bits from the bottom of src into the bits of dst starting at
+ * bit off. The other bits of dst are not changed.
+ */
+static void set_field(unsigned long*dst, unsigned off,
+		      const unsigned long*src, unsigned n)
+{
+      for (unsigned idx = 0 ;  idx < n ;  idx += BPW) {
+	    unsigned cnt = n - idx;
+	    unsigned long mask = ~0UL;
+	    if (cnt < BPW)
+		  mask = (1UL << cnt) - 1UL;
+	    else
+		  cnt = BPW;
+
+	    unsigned long word = src[idx/BPW] & mask;
+	    unsigned dw = (off+idx) / BPW;
+	    unsigned ds = (off+idx) % BPW;
+	    dst[dw] = (dst[dw] & ~(mask << ds)) | (word << ds);
+	    if (ds != 0 && ds+cnt > BPW) {
+		  dst[dw+1] = (dst[dw+1] & ~(mask >> (BPW-ds)))
+			    | (word >> (BPW-ds));
+	    }
+      }
+}
+
+/*
+ * Copy the n bits of src starting at bit off into the bottom of
+ * dst. The words of dst past the copied bits are zero filled.
+ */
+static void get_field(unsigned long*dst, const unsigned long*src,
+		      unsigned off, unsigned n)
+{
+      if (n == 0)
+	    return;
+
+      unsigned ws = off / BPW;
+      unsigned sh = off % BPW;
+      unsigned nw = words_for(n);
+      unsigned src_end = words_for(off+n);
+      for (unsigned idx = 0 ;  idx < nw ;  idx += 1) {
+	    unsigned long word = src[ws+idx] >> sh;
+	    if (sh != 0 && ws+idx+1 < src_end)
+		  word |= src[ws+idx+1] << (BPW-sh);
+	    dst[idx] = word;
+      }
+      dst[nw-1] &= top_word_mask(n);
+}
+
+/*
+ * Set the n bits of dst starting at bit off to all zeros or all ones.
+ */
+static void fill_field(unsigned long*dst, unsigned off, unsigned n, bool bit)
+{
+      unsigned idx = off;
+      while (idx < off+n) {
+	    unsigned ds = idx % BPW;
+	    unsigned cnt = BPW - ds;
+	    if (cnt > off+n-idx)
+		  cnt = off+n-idx;
+	    unsigned long mask = (cnt < BPW)? ((1UL << cnt) - 1UL) << ds : ~0UL;
+	    if (bit)
+		  dst[idx/BPW] |= mask;
+	    else
+		  dst[idx/BPW] &= ~mask;
+	    idx += cnt;
+      }
+}
+
+void verinum::allocate_(unsigned nbits)
+{
+      nbits_ = nbits;
+      unsigned nw = words_for(nbits);
+      if (nw == 0) {
+	    abits_ = 0;
+	    bbits_ = 0;
+	    return;
+      }
+
+      abits_ = new unsigned long[2*nw];
+      bbits_ = abits_ + nw;
+      memset(abits_, 0, 2*nw*sizeof(unsigned long));
+}
+
 verinum::verinum()
-: bits_(0), nbits_(0), has_len_(false), has_sign_(false), is_single_(false), string_flag_(false)
+: abits_(0), bbits_(0), nbits_(0), has_len_(false), has_sign_(false), is_single_(false), string_flag_(false)
 {
 }
 
 verinum::verinum(const V*bits, unsigned nbits, bool has_len__)
 : has_len_(has_len__), has_sign_(false), is_single_(false), string_flag_(false)
 {
-      nbits_ = nbits;
-      bits_ = new V [nbits];
+      allocate_(nbits);
       for (unsigned idx = 0 ;  idx < nbits ;  idx += 1) {
-	    bits_[idx] = bits[idx];
+	    unsigned long mask = 1UL << (idx%BPW);
+	    if (v_abit(bits[idx])) abits_[idx/BPW] |= mask;
+	    if (v_bbit(bits[idx])) bbits_[idx/BPW] |= mask;
       }
 }
 
+verinum::verinum(const unsigned long*abits, const unsigned long*bbits,
+		 unsigned nbits, bool has_len__)
+: has_len_(has_len__), has_sign_(false), is_single_(false), string_flag_(false)
+{
+      allocate_(nbits);
+      unsigned nw = words_for(nbits);
+      if (nw == 0)
+	    return;
+
+      for (unsigned idx = 0 ;  idx < nw ;  idx += 1) {
+	    abits_[idx] = abits[idx];
+	    bbits_[idx] = bbits? bbits[idx] : 0UL;
+      }
+      abits_[nw-1] &= top_word_mask(nbits);
+      bbits_[nw-1] &= top_word_mask(nbits);
+}
+
 static string process_verilog_string_quotes(const string&str)
 {
       string res;
@@ -115,58 +269,46 @@ verinum::verinum(const string&s)
 : has_len_(true), has_sign_(false), is_single_(false), string_flag_(true)
 {
       string str = process_verilog_string_quotes(s);
-      nbits_ = str.length() * 8;
 
 	// Special case: The string "" is 8 bits of 0.
-      if (nbits_ == 0) {
-	    nbits_ = 8;
-	    bits_ = new V [nbits_];
-	    bits_[0] = V0;
-	    bits_[1] = V0;
-	    bits_[2] = V0;
-	    bits_[3] = V0;
-	    bits_[4] = V0;
-	    bits_[5] = V0;
-	    bits_[6] = V0;
-	    bits_[7] = V0;
+      if (str.length() == 0) {
+	    allocate_(8);
 	    return;
       }
 
-      bits_ = new V [nbits_];
+      allocate_(str.length() * 8);
 
-      unsigned idx, cp;
-      V*bp = bits_+nbits_;
-      for (idx = nbits_, cp = 0 ;  idx > 0 ;  idx -= 8, cp += 1) {
-	    char ch = str[cp];
-	    *(--bp) = (ch&0x80) ? V1 : V0;
-	    *(--bp) = (ch&0x40) ? V1 : V0;
-	    *(--bp) = (ch&0x20) ? V1 : V0;
-	    *(--bp) = (ch&0x10) ? V1 : V0;
-	    *(--bp) = (ch&0x08) ? V1 : V0;
-	    *(--bp) = (ch&0x04) ? V1 : V0;
-	    *(--bp) = (ch&0x02) ? V1 : V0;
-	    *(--bp) = (ch&0x01) ? V1 : V0;
+	// The first character is the most significant byte.
+      unsigned cnt = str.length();
+      for (unsigned cp = 0 ;  cp < cnt ;  cp += 1) {
+	    unsigned off = 8 * (cnt-1-cp);
+	    unsigned long ch = (unsigned char)str[cp];
+	    abits_[off/BPW] |= ch << (off%BPW);
       }
 }
 
 verinum::verinum(verinum::V val, unsigned n, bool h)
 : has_len_(h), has_sign_(false), is_single_(false), string_flag_(false)
 {
-      nbits_ = n;
-      bits_ = new V[nbits_];
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1)
-	    bits_[idx] = val;
+      allocate_(n);
+      fill_field(abits_, 0, n, v_abit(val));
+      fill_field(bbits_, 0, n, v_bbit(val));
 }
 
 verinum::verinum(uint64_t val, unsigned n)
 : has_len_(true), has_sign_(false), is_single_(false), string_flag_(false)
 {
-      nbits_ = n;
-      bits_ = new V[nbits_];
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1) {
-	    bits_[idx] = (val&1) ? V1 : V0;
-	    val >>= (uint64_t)1;
-      }
+      allocate_(n);
+      unsigned nw = words_for(n);
+      for (unsigned idx = 0 ;  idx < nw && val != 0 ;  idx += 1) {
+	    abits_[idx] = (unsigned long)val;
+	      // Shift in two steps, since the word may be as wide
+	      // as the value.
+	    val >>= BPW/2;
+	    val >>= BPW/2;
+      }
+      if (nw > 0)
+	    abits_[nw-1] &= top_word_mask(n);
 }
 
 /* The second argument is not used! It is there to make this
@@ -181,9 +323,8 @@ verinum::verinum(double val, bool)
 
 	/* We return `bx for a NaN or +/- infinity. */
       if (val != val || (val && (val == 0.5*val))) {
-	    nbits_ = 1;
-	    bits_ = new V[nbits_];
-	    bits_[0] = Vx;
+	    allocate_(1);
+	    set(0, Vx);
 	    return;
       }
 
@@ -199,17 +340,13 @@ verinum::verinum(double val, bool)
 
 	/* Get the exponent and fractional part of the number. */
       fraction = frexp(val, &exponent);
-      nbits_ = exponent+1;
-      bits_ = new V[nbits_];
+      allocate_(exponent+1);
 
 	/* If the value is small enough just use lround(). */
       if (nbits_ <= BITS_IN_LONG) {
 	    long sval = lround(val);
 	    if (is_neg) sval = -sval;
-	    for (unsigned idx = 0; idx < nbits_; idx += 1) {
-		  bits_[idx] = (sval&1) ? V1 : V0;
-		  sval >>= 1;
-	    }
+	    abits_[0] = (unsigned long)sval & top_word_mask(nbits_);
 	      /* Trim the result. */
 	    signed_trim();
 	    return;
@@ -222,20 +359,16 @@ verinum::verinum(double val, bool)
       if (nwords == 0) {
 	    unsigned long bits = (unsigned long) fraction;
 	    fraction = fraction - (double) bits;
-	    for (unsigned idx = 0; idx < nbits_; idx += 1) {
-		  bits_[idx] = (bits&1) ? V1 : V0;
-		  bits >>= 1;
-	    }
+	    set_field(abits_, 0, &bits,
+		      nbits_ < BITS_IN_LONG? nbits_ : BITS_IN_LONG);
       } else {
 	    for (int wd = nwords; wd >= 0; wd -= 1) {
 		  unsigned long bits = (unsigned long) fraction;
 		  fraction = fraction - (double) bits;
 		  unsigned max_idx = (wd+1)*BITS_IN_LONG;
 		  if (max_idx > nbits_) max_idx = nbits_;
-		  for (unsigned idx = wd*BITS_IN_LONG; idx < max_idx; idx += 1) {
-			bits_[idx] = (bits&1) ? V1 : V0;
-			bits >>= 1;
-		  }
+		  set_field(abits_, wd*BITS_IN_LONG, &bits,
+			    max_idx - wd*BITS_IN_LONG);
 		  fraction = ldexp(fraction, BITS_IN_LONG);
 	    }
       }
@@ -256,43 +389,41 @@ void verinum::signed_trim()
 {
 	/* Do we have any extra digits? */
       unsigned tlen = nbits_-1;
-      verinum::V sign = bits_[tlen];
-      while ((tlen > 0) && (bits_[tlen] == sign)) tlen -= 1;
+      verinum::V sign = get(tlen);
+      while ((tlen > 0) && (get(tlen) == sign)) tlen -= 1;
 
 	/* tlen now points to the first digit that is not the sign.
 	 * or bit 0. Set the length to include this bit and one proper
 	 * sign bit if needed. */
-      if (bits_[tlen] != sign) tlen += 1;
+      if (get(tlen) != sign) tlen += 1;
       tlen += 1;
 
 	/* Trim the bits if needed. */
       if (tlen < nbits_) {
-	    V* tbits = new V[tlen];
-	    for (unsigned idx = 0; idx < tlen; idx += 1)
-		  tbits[idx] = bits_[idx];
-	    delete[] bits_;
-	    bits_ = tbits;
-	    nbits_ = tlen;
+	    unsigned long*old_abits = abits_;
+	    unsigned long*old_bbits = bbits_;
+	    allocate_(tlen);
+	    set_field(abits_, 0, old_abits, tlen);
+	    set_field(bbits_, 0, old_bbits, tlen);
+	    delete[]old_abits;
       }
 }
 
 verinum::verinum(const verinum&that)
 {
       string_flag_ = that.string_flag_;
-      nbits_ = that.nbits_;
-      bits_ = new V[nbits_];
+      allocate_(that.nbits_);
       has_len_ = that.has_len_;
       has_sign_ = that.has_sign_;
       is_single_ = that.is_single_;
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1)
-	    bits_[idx] = that.bits_[idx];
+      if (nbits_ > 0)
+	    memcpy(abits_, that.abits_, 2*words_for(nbits_)*sizeof(unsigned long));
 }
 
 verinum::verinum(const verinum&that, unsigned nbits)
 {
       string_flag_ = that.string_flag_ && (that.nbits_ == nbits);
-      nbits_ = nbits;
-      bits_ = new V[nbits_];
+      allocate_(nbits);
       has_len_ = true;
       has_sign_ = that.has_sign_;
       is_single_ = false;
@@ -300,16 +431,13 @@ verinum::verinum(const verinum&that, unsigned nbits)
       unsigned copy = nbits;
       if (copy > that.nbits_)
 	    copy = that.nbits_;
-      for (unsigned idx = 0 ;  idx < copy ;  idx += 1)
-	    bits_[idx] = that.bits_[idx];
+      set_field(abits_, 0, that.abits_, copy);
+      set_field(bbits_, 0, that.bbits_, copy);
 
-      if (copy < nbits_) {
+      if (copy > 0 && copy < nbits_) {
 	    if (has_sign_ || that.is_single_) {
-		  for (unsigned idx = copy ;  idx < nbits_ ;  idx += 1)
-			bits_[idx] = bits_[idx-1];
-	    } else {
-		  for (unsigned idx = copy ;  idx < nbits_ ;  idx += 1)
-			bits_[idx] = verinum::V0;
+		  fill_field(abits_, copy, nbits_-copy, word_bit(abits_, copy-1));
+		  fill_field(bbits_, copy, nbits_-copy, word_bit(bbits_, copy-1));
 	    }
       }
 }
@@ -321,36 +449,38 @@ verinum::verinum(int64_t that)
 
       if (that < 0) tmp = (that+1)/2;
       else tmp = that/2;
-      nbits_ = 1;
+      unsigned nbits = 1;
       while (tmp != 0) {
-	    nbits_ += 1;
+	    nbits += 1;
 	    tmp /= 2;
       }
 
-      nbits_ += 1;
+      nbits += 1;
 
-      bits_ = new V[nbits_];
+      allocate_(nbits);
       for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1) {
-	    bits_[idx] = (that & 1)? V1 : V0;
+	    if (that & 1)
+		  abits_[idx/BPW] |= 1UL << (idx%BPW);
 	    that >>= 1;
       }
 }
 
 verinum::~verinum()
 {
-      delete[]bits_;
+      delete[]abits_;
 }
 
 verinum& verinum::operator= (const verinum&that)
 {
       if (this == &that) return *this;
-      if (nbits_ != that.nbits_) {
-            delete[]bits_;
-            nbits_ = that.nbits_;
-            bits_ = new V[that.nbits_];
+      if (words_for(nbits_) != words_for(that.nbits_)) {
+            delete[]abits_;
+            allocate_(that.nbits_);
+      } else {
+	    nbits_ = that.nbits_;
       }
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1)
-	    bits_[idx] = that.bits_[idx];
+      if (nbits_ > 0)
+	    memcpy(abits_, that.abits_, 2*words_for(nbits_)*sizeof(unsigned long));
 
       has_len_ = that.has_len_;
       has_sign_ = that.has_sign_;
@@ -362,20 +492,52 @@ verinum& verinum::operator= (const verinum&that)
 verinum::V verinum::get(unsigned idx) const
 {
       assert(idx < nbits_);
-      return bits_[idx];
+      unsigned w = idx / BPW;
+      unsigned s = idx % BPW;
+      unsigned code = ((abits_[w] >> s) & 1UL) | (((bbits_[w] >> s) & 1UL) << 1);
+      return bits_to_v[code];
 }
 
 verinum::V verinum::set(unsigned idx, verinum::V val)
 {
       assert(idx < nbits_);
-      return bits_[idx] = val;
+      unsigned long mask = 1UL << (idx%BPW);
+      unsigned w = idx / BPW;
+      if (v_abit(val))
+	    abits_[w] |= mask;
+      else
+	    abits_[w] &= ~mask;
+      if (v_bbit(val))
+	    bbits_[w] |= mask;
+      else
+	    bbits_[w] &= ~mask;
+      return val;
 }
 
 void verinum::set(unsigned off, const verinum&val)
 {
       assert(off + val.len() <= nbits_);
-      for (unsigned idx = 0 ; idx < val.len() ; idx += 1)
-	    bits_[off+idx] = val[idx];
+      set_field(abits_, off, val.abits_, val.nbits_);
+      set_field(bbits_, off, val.bbits_, val.nbits_);
+}
+
+/*
+ * Return true if any of the bits at or above bit "from" of the value
+ * plane are set.
+ */
+static bool any_bits_from(const unsigned long*words, unsigned nbits, unsigned from)
+{
+      if (from >= nbits)
+	    return false;
+
+      unsigned nw = words_for(nbits);
+      unsigned w = from / BPW;
+      if (words[w] >> (from%BPW))
+	    return true;
+      for (w += 1 ;  w < nw ;  w += 1)
+	    if (words[w]) return true;
+
+      return false;
 }
 
 unsigned verinum::as_unsigned() const
@@ -386,15 +548,10 @@ unsigned verinum::as_unsigned() const
       if (!is_defined())
 	    return 0;
 
-      unsigned val = 0;
-      unsigned mask = 1;
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1, mask <<= 1)
-	    if (bits_[idx] == V1) {
-		  if (mask == 0) return ~mask;
-		  val |= mask;
-	    }
+      if (any_bits_from(abits_, nbits_, 8*sizeof(unsigned)))
+	    return ~0U;
 
-      return val;
+      return (unsigned)abits_[0];
 }
 
 unsigned long verinum::as_ulong() const
@@ -405,15 +562,10 @@ unsigned long verinum::as_ulong() const
       if (!is_defined())
 	    return 0;
 
-      unsigned long val = 0;
-      unsigned long mask = 1;
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1, mask <<= 1)
-	    if (bits_[idx] == V1) {
-		  if (mask == 0) return ~mask;
-		  val |= mask;
-	    }
+      if (any_bits_from(abits_, nbits_, BPW))
+	    return ~0UL;
 
-      return val;
+      return abits_[0];
 }
 
 uint64_t verinum::as_ulong64() const
@@ -424,13 +576,13 @@ uint64_t verinum::as_ulong64() const
       if (!is_defined())
 	    return 0;
 
+      if (any_bits_from(abits_, nbits_, 64))
+	    return ~(uint64_t)0;
+
       uint64_t val = 0;
-      uint64_t mask = 1;
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1, mask <<= 1)
-	    if (bits_[idx] == V1) {
-		  if (mask == 0) return ~mask;
-		  val |= mask;
-	    }
+      unsigned nw = words_for(nbits_);
+      for (unsigned idx = 0 ;  idx < nw && idx*BPW < 64 ;  idx += 1)
+	    val |= (uint64_t)abits_[idx] << (idx*BPW);
 
       return val;
 }
@@ -465,27 +617,19 @@ signed long verinum::as_long() const
       }
       int lost_bits=0;
 
-      if (has_sign_ && (bits_[nbits_-1] == V1)) {
-	    val = -1;
-	    signed long mask = ~1L;
-	    for (unsigned idx = 0 ;  idx < top ;  idx += 1) {
-		  if (bits_[idx] == V0) val &= mask;
-		  mask = (mask << 1) | 1L;
-	    }
+	// The low top bits are all in the first word.
+      unsigned long mask = (1UL << top) - 1UL;
+      if (has_sign_ && word_bit(abits_, nbits_-1)) {
+	    val = (signed long)(abits_[0] | ~mask);
 	    if (diag_top) {
 		  for (unsigned idx = top; idx < diag_top; idx += 1) {
-			if (bits_[idx] == V0) lost_bits=1;
+			if (! word_bit(abits_, idx)) lost_bits=1;
 		  }
 	    }
       } else {
-	    signed long mask = 1;
-	    for (unsigned idx = 0 ;  idx < top ;  idx += 1, mask <<= 1) {
-		  if (bits_[idx] == V1) val |= mask;
-	    }
+	    val = (signed long)(abits_[0] & mask);
 	    if (diag_top) {
-		  for (unsigned idx = top; idx < diag_top; idx += 1) {
-			if (bits_[idx] == V1) lost_bits=1;
-		  }
+		  if (any_bits_from(abits_, nbits_, top)) lost_bits=1;
 	    }
       }
 
@@ -501,17 +645,17 @@ double verinum::as_double() const
 
       double val = 0.0;
         /* Do we have/want a signed value? */
-      if (has_sign_ && bits_[nbits_-1] == V1) {
+      if (has_sign_ && get(nbits_-1) == V1) {
 	    V carry = V1;
 	    for (unsigned idx = 0; idx < nbits_; idx += 1) {
-		  V sum = add_with_carry(~bits_[idx], V0, carry);
+		  V sum = add_with_carry(~get(idx), V0, carry);
 		  if (sum == V1)
 			val += pow(2.0, (double)idx);
 	    }
 	    val *= -1.0;
       } else {
 	    for (unsigned idx = 0; idx < nbits_; idx += 1) {
-		  if (bits_[idx] == V1)
+		  if (get(idx) == V1)
 			val += pow(2.0, (double)idx);
 	    }
       }
@@ -526,17 +670,9 @@ string verinum::as_string() const
 
       string res;
       for (unsigned idx = nbits_ ;  idx > 0 ;  idx -= 8) {
-	    char char_val = 0;
-	    V*bp = bits_+idx;
-
-	    if (*(--bp) == V1) char_val |= 0x80;
-	    if (*(--bp) == V1) char_val |= 0x40;
-	    if (*(--bp) == V1) char_val |= 0x20;
-	    if (*(--bp) == V1) char_val |= 0x10;
-	    if (*(--bp) == V1) char_val |= 0x08;
-	    if (*(--bp) == V1) char_val |= 0x04;
-	    if (*(--bp) == V1) char_val |= 0x02;
-	    if (*(--bp) == V1) char_val |= 0x01;
+	    unsigned off = idx - 8;
+	    char char_val = (char)((abits_[off/BPW] & ~bbits_[off/BPW])
+				   >> (off%BPW));
 
 	    if (char_val == '"' || char_val == '\\') {
 		  char tmp[5];
@@ -559,32 +695,33 @@ bool verinum::is_before(const verinum&that) const
       if (that.nbits_ < nbits_) return false;
 
       for (unsigned idx = nbits_  ;  idx > 0 ;  idx -= 1) {
-	    if (bits_[idx-1] < that.bits_[idx-1]) return true;
-	    if (bits_[idx-1] > that.bits_[idx-1]) return false;
+	    if (get(idx-1) < that.get(idx-1)) return true;
+	    if (get(idx-1) > that.get(idx-1)) return false;
       }
       return false;
 }
 
 bool verinum::is_defined() const
 {
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1) {
-	    if (bits_[idx] == Vx) return false;
-	    if (bits_[idx] == Vz) return false;
+      unsigned nw = words_for(nbits_);
+      for (unsigned idx = 0 ;  idx < nw ;  idx += 1) {
+	    if (bbits_[idx]) return false;
       }
       return true;
 }
 
 bool verinum::is_zero() const
 {
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1)
-	    if (bits_[idx] != V0) return false;
+      unsigned nw = words_for(nbits_);
+      for (unsigned idx = 0 ;  idx < nw ;  idx += 1)
+	    if (abits_[idx] || bbits_[idx]) return false;
 
       return true;
 }
 
 bool verinum::is_negative() const
 {
-      return (bits_[nbits_-1] == V1) && has_sign();
+      return (get(nbits_-1) == V1) && has_sign();
 }
 
 unsigned verinum::significant_bits() const
@@ -592,11 +729,11 @@ unsigned verinum::significant_bits() const
       unsigned sbits = nbits_;
 
       if (has_sign_) {
-	    V sign_bit = bits_[sbits-1];
-	    while ((sbits > 1) && (bits_[sbits-2] == sign_bit))
+	    V sign_bit = get(sbits-1);
+	    while ((sbits > 1) && (get(sbits-2) == sign_bit))
 		  sbits -= 1;
       } else {
-	    while ((sbits > 1) && (bits_[sbits-1] == verinum::V0))
+	    while ((sbits > 1) && (get(sbits-1) == verinum::V0))
 		  sbits -= 1;
       }
       return sbits;
@@ -604,9 +741,10 @@ unsigned verinum::significant_bits() const
 
 void verinum::cast_to_int2()
 {
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1) {
-	    if (bits_[idx] == Vx || bits_[idx] == Vz)
-		  bits_[idx] = V0;
+      unsigned nw = words_for(nbits_);
+      for (unsigned idx = 0 ;  idx < nw ;  idx += 1) {
+	    abits_[idx] &= ~bbits_[idx];
+	    bbits_[idx] = 0;
       }
 }
 
@@ -632,9 +770,7 @@ verinum pad_to_width(const verinum&that, unsigned width)
       }
 
       verinum val(pad, width, that.has_len());
-
-      for (unsigned idx = 0 ;  idx < that.len() ;  idx += 1)
-	    val.set(idx, that[idx]);
+      val.set(0, that);
 
       val.has_sign(that.has_sign());
       if (that.is_string() && (width % 8) == 0) {
@@ -668,9 +804,7 @@ verinum cast_to_width(const verinum&that, unsigned width)
       }
 
       verinum val(pad, width, true);
-
-      for (unsigned idx = 0 ;  idx < that.len() ;  idx += 1)
-	    val.set(idx, that[idx]);
+      val.set(0, that);
 
       val.has_sign(that.has_sign());
       return val;
@@ -733,11 +867,8 @@ verinum trim_vnum(const verinum&that)
 	    if (that.get(top) == verinum::V0) tlen -= 1;
       }
 
-      verinum tmp (verinum::V0, tlen, false);
-      tmp.has_sign(that.has_sign());
-      for (unsigned idx = 0 ;  idx < tmp.len() ;  idx += 1)
-	    tmp.set(idx, that.get(idx));
-
+      verinum tmp (that, tlen);
+      tmp.has_len(false);
       return tmp;
 }
 
@@ -841,6 +972,18 @@ verinum::V operator == (const verinum&left, const verinum&right)
       if (right.len() > max_len)
 	    max_len = right.len();
 
+	// Fully defined values can be compared a word at a time.
+      if (left.is_defined() && right.is_defined()) {
+	    bool pad = left_pad == verinum::V1;
+	    unsigned nw = words_for(max_len);
+	    for (unsigned idx = 0 ;  idx < nw ;  idx += 1) {
+		  if (ext_word(left.abits_words(), left.len(), idx, pad)
+		      != ext_word(right.abits_words(), right.len(), idx, pad))
+			return verinum::V0;
+	    }
+	    return verinum::V1;
+      }
+
       for (unsigned idx = 0 ;  idx < max_len ;  idx += 1) {
 	    verinum::V left_bit  = idx < left.len() ? left[idx]  : left_pad;
 	    verinum::V right_bit = idx < right.len()? right[idx] : right_pad;
@@ -851,6 +994,25 @@ verinum::V operator == (const verinum&left, const verinum&right)
       return verinum::V1;
 }
 
+/*
+ * Compare fully defined values a word at a time, from the most
+ * significant word down. The values have the same sign (pad) by now,
+ * so the sign extended words can be compared as unsigned words. The
+ * if_equal value is returned if the values are equal.
+ */
+static verinum::V compare_words(const verinum&left, const verinum&right,
+				bool pad, verinum::V if_equal)
+{
+      unsigned nw = words_for(max(left.len(), right.len()));
+      for (unsigned idx = nw ;  idx > 0 ;  idx -= 1) {
+	    unsigned long lw = ext_word(left.abits_words(), left.len(), idx-1, pad);
+	    unsigned long rw = ext_word(right.abits_words(), right.len(), idx-1, pad);
+	    if (lw < rw) return verinum::V1;
+	    if (lw > rw) return verinum::V0;
+      }
+      return if_equal;
+}
+
 verinum::V operator <= (const verinum&left, const verinum&right)
 {
       verinum::V left_pad = verinum::V0;
@@ -866,6 +1028,9 @@ verinum::V operator <= (const verinum&left, const verinum&right)
 		  return verinum::V0;
       }
 
+      if (left.is_defined() && right.is_defined())
+	    return compare_words(left, right, left_pad == verinum::V1, verinum::V1);
+
       unsigned idx;
       for (idx = left.len() ; idx > right.len() ;  idx -= 1) {
 	    if (left[idx-1] != right_pad) {
@@ -918,6 +1083,9 @@ verinum::V operator < (const verinum&left, const verinum&right)
 		  return verinum::V0;
       }
 
+      if (left.is_defined() && right.is_defined())
+	    return compare_words(left, right, left_pad == verinum::V1, verinum::V0);
+
       unsigned idx;
       for (idx = left.len() ; idx > right.len() ;  idx -= 1) {
 	    if (left[idx-1] != right_pad) {
@@ -1020,18 +1188,48 @@ verinum operator ~ (const verinum&left)
 }
 
 /*
- * Addition and subtraction works a bit at a time, from the least
+ * Addition and subtraction work a word at a time, from the least
  * significant up to the most significant. The result is signed only
  * if both of the operands are signed. If either operand is unsized,
  * the result is expanded as needed to prevent overflow.
+ *
+ * The add_words function does the work for fully defined operands. It
+ * sign extends (if the pad flags are set) both operands to nbits, and
+ * adds them and the carry in. If the rinv flag is set the right
+ * operand is inverted first, so that with a carry in of 1 this
+ * subtracts the right operand.
  */
+static void add_words(unsigned long*res, unsigned nbits,
+		      const verinum&left, bool lpad,
+		      const verinum&right, bool rpad, bool rinv,
+		      unsigned long carry)
+{
+      unsigned nw = words_for(nbits);
+      for (unsigned idx = 0 ;  idx < nw ;  idx += 1) {
+	    unsigned long lw = ext_word(left.abits_words(), left.len(), idx, lpad);
+	    unsigned long rw = ext_word(right.abits_words(), right.len(), idx, rpad);
+	    if (rinv) rw = ~rw;
+	    unsigned long sum = lw + rw;
+	    unsigned long c1 = sum < lw;
+	    sum += carry;
+	    unsigned long c2 = sum < carry;
+	    res[idx] = sum;
+	    carry = c1 | c2;
+      }
+      if (nw > 0)
+	    res[nw-1] &= top_word_mask(nbits);
+}
+
+static inline bool sign_pad(const verinum&val)
+{
+      return val.has_sign() && val.len() > 0 && word_bit(val.abits_words(), val.len()-1);
+}
 
 verinum operator + (const verinum&left, const verinum&right)
 {
       const bool has_len_flag = left.has_len() && right.has_len();
       const bool signed_flag = left.has_sign() && right.has_sign();
 
-      unsigned min_len = min(left.len(), right.len());
       unsigned max_len = max(left.len(), right.len());
 
 	// If either the left or right values are undefined, the
@@ -1043,36 +1241,21 @@ verinum operator + (const verinum&left, const verinum&right)
 	    return result;
       }
 
-      verinum::V*val_bits = new verinum::V[max_len+1];
-
-      verinum::V carry = verinum::V0;
-      for (unsigned idx = 0 ;  idx < min_len ;  idx += 1)
-	    val_bits[idx] = add_with_carry(left[idx], right[idx], carry);
-
-      verinum::V rpad = sign_bit(right);
-      verinum::V lpad = sign_bit(left);
-
-      if (left.len() > right.len()) {
-
-	    for (unsigned idx = min_len ;  idx < max_len ;  idx += 1)
-		  val_bits[idx] = add_with_carry(left[idx], rpad, carry);
-
-      } else {
-
-	    for (unsigned idx = min_len ;  idx < max_len ;  idx += 1)
-		  val_bits[idx] = add_with_carry(lpad, right[idx], carry);
-      }
+	// Calculate one extra bit in case the result needs to grow.
+      unsigned long*val_bits = new unsigned long[words_for(max_len+1)];
+      add_words(val_bits, max_len+1, left, sign_pad(left),
+		right, sign_pad(right), false, 0);
 
       unsigned len = max_len;
-      if (!has_len_flag) {
-	    val_bits[max_len] = add_with_carry(lpad, rpad, carry);
+      if (!has_len_flag && max_len > 0) {
+	    bool top = word_bit(val_bits, max_len);
 	    if (signed_flag) {
-		  if (val_bits[max_len] != val_bits[max_len-1]) len += 1;
+		  if (top != word_bit(val_bits, max_len-1)) len += 1;
 	    } else {
-		  if (val_bits[max_len] != verinum::V0) len += 1;
+		  if (top) len += 1;
 	    }
       }
-      verinum result (val_bits, len, has_len_flag);
+      verinum result (val_bits, 0, len, has_len_flag);
       result.has_sign(signed_flag);
 
       delete[]val_bits;
@@ -1085,7 +1268,6 @@ verinum operator - (const verinum&left, const verinum&right)
       const bool has_len_flag = left.has_len() && right.has_len();
       const bool signed_flag = left.has_sign() && right.has_sign();
 
-      unsigned min_len = min(left.len(), right.len());
       unsigned max_len = max(left.len(), right.len());
 
 	// If either the left or right values are undefined, the
@@ -1097,32 +1279,16 @@ verinum operator - (const verinum&left, const verinum&right)
 	    return result;
       }
 
-      verinum::V*val_bits = new verinum::V[max_len+1];
-
-      verinum::V carry = verinum::V1;
-      for (unsigned idx = 0 ;  idx < min_len ;  idx += 1)
-	    val_bits[idx] = add_with_carry(left[idx], ~right[idx], carry);
-
-      verinum::V rpad = sign_bit(right);
-      verinum::V lpad = sign_bit(left);
-
-      if (left.len() > right.len()) {
-
-	    for (unsigned idx = min_len ;  idx < max_len ;  idx += 1)
-		  val_bits[idx] = add_with_carry(left[idx], ~rpad, carry);
-
-      } else {
-
-	    for (unsigned idx = min_len ;  idx < max_len ;  idx += 1)
-		  val_bits[idx] = add_with_carry(lpad, ~right[idx], carry);
-      }
+      unsigned long*val_bits = new unsigned long[words_for(max_len+1)];
+      add_words(val_bits, max_len+1, left, sign_pad(left),
+		right, sign_pad(right), true, 1);
 
       unsigned len = max_len;
-      if (signed_flag && !has_len_flag) {
-	    val_bits[max_len] = add_with_carry(lpad, ~rpad, carry);
-	    if (val_bits[max_len] != val_bits[max_len-1]) len += 1;
+      if (signed_flag && !has_len_flag && max_len > 0) {
+	    if (word_bit(val_bits, max_len) != word_bit(val_bits, max_len-1))
+		  len += 1;
       }
-      verinum result (val_bits, len, has_len_flag);
+      verinum result (val_bits, 0, len, has_len_flag);
       result.has_sign(signed_flag);
 
       delete[]val_bits;
@@ -1145,17 +1311,14 @@ verinum operator - (const verinum&right)
 	    return result;
       }
 
-      verinum::V*val_bits = new verinum::V[len+1];
+      unsigned long*val_bits = new unsigned long[words_for(len+1)];
+      add_words(val_bits, len+1, verinum(), false,
+		right, sign_pad(right), true, 1);
 
-      verinum::V carry = verinum::V1;
-      for (unsigned idx = 0 ;  idx < len ;  idx += 1)
-	    val_bits[idx] = add_with_carry(verinum::V0, ~right[idx], carry);
-
-      if (signed_flag && !has_len_flag) {
-	    val_bits[len] = add_with_carry(verinum::V0, ~sign_bit(right), carry);
-	    if (val_bits[len] != val_bits[len-1]) len += 1;
+      if (signed_flag && !has_len_flag && len > 0) {
+	    if (word_bit(val_bits, len) != word_bit(val_bits, len-1)) len += 1;
       }
-      verinum result (val_bits, len, has_len_flag);
+      verinum result (val_bits, 0, len, has_len_flag);
       result.has_sign(signed_flag);
 
       delete[]val_bits;
@@ -1169,9 +1332,52 @@ verinum operator - (const verinum&right)
  * operand is unsized, the resulting number is as large as the sum of
  * the sizes of the operands.
  *
- * The algorithm used is successive shift and add operations,
- * implemented as the nested loops.
+ * Both operands are sign extended to the result width, and the result
+ * is the low bits of their product. The product is calculated with
+ * long multiplication on 32bit digits, so that the partial products
+ * fit in a uint64_t.
  */
+static void mul_words(unsigned long*res, unsigned nbits,
+		      const verinum&left, bool lpad,
+		      const verinum&right, bool rpad)
+{
+      unsigned nd = (nbits + 31) / 32;
+      uint32_t*ldig = new uint32_t[3*nd];
+      uint32_t*rdig = ldig + nd;
+      uint32_t*prod = rdig + nd;
+
+      for (unsigned idx = 0 ;  idx < nd ;  idx += 1) {
+	    unsigned w = idx*32 / BPW;
+	    unsigned s = idx*32 % BPW;
+	    ldig[idx] = ext_word(left.abits_words(), left.len(), w, lpad) >> s;
+	    rdig[idx] = ext_word(right.abits_words(), right.len(), w, rpad) >> s;
+	    prod[idx] = 0;
+      }
+
+      for (unsigned rdx = 0 ;  rdx < nd ;  rdx += 1) {
+	    if (rdig[rdx] == 0)
+		  continue;
+
+	    uint64_t carry = 0;
+	    for (unsigned ldx = 0 ;  ldx < nd-rdx ;  ldx += 1) {
+		  uint64_t tmp = (uint64_t)ldig[ldx] * rdig[rdx]
+			       + prod[ldx+rdx] + carry;
+		  prod[ldx+rdx] = (uint32_t)tmp;
+		  carry = tmp >> 32;
+	    }
+      }
+
+      unsigned nw = words_for(nbits);
+      for (unsigned idx = 0 ;  idx < nw ;  idx += 1)
+	    res[idx] = 0;
+      for (unsigned idx = 0 ;  idx < nd ;  idx += 1)
+	    res[idx*32/BPW] |= (unsigned long)prod[idx] << (idx*32 % BPW);
+      if (nw > 0)
+	    res[nw-1] &= top_word_mask(nbits);
+
+      delete[]ldig;
+}
+
 verinum operator * (const verinum&left, const verinum&right)
 {
       const bool has_len_flag = left.has_len() && right.has_len();
@@ -1190,25 +1396,13 @@ verinum operator * (const verinum&left, const verinum&right)
 	    return result;
       }
 
-      verinum result(verinum::V0, len, has_len_flag);
-      result.has_sign(signed_flag);
-
-      verinum::V r_sign = sign_bit(right);
-      for (unsigned rdx = 0 ;  rdx < len ;  rdx += 1) {
+      unsigned long*val_bits = new unsigned long[words_for(len)];
+      mul_words(val_bits, len, left, sign_pad(left), right, sign_pad(right));
 
-	    verinum::V r_bit = rdx < r_len ? right.get(rdx) : r_sign;
-	    if (r_bit == verinum::V0)
-		  continue;
+      verinum result(val_bits, 0, len, has_len_flag);
+      result.has_sign(signed_flag);
 
-	    verinum::V l_sign = sign_bit(left);
-	    verinum::V carry = verinum::V0;
-	    for (unsigned ldx = 0 ;  ldx < (len - rdx) ;  ldx += 1) {
-		  verinum::V l_bit = ldx < l_len ? left[ldx] : l_sign;
-		  result.set(ldx+rdx, add_with_carry(l_bit,
-						     result[rdx+ldx],
-						     carry));
-	    }
-      }
+      delete[]val_bits;
 
       return trim_vnum(result);
 }
@@ -1310,11 +1504,22 @@ verinum operator << (const verinum&that, unsigned shift)
       unsigned len = that.len();
       if (!has_len_flag) len += shift;
 
-      verinum result(verinum::V0, len, has_len_flag);
+      unsigned nw = words_for(len);
+      unsigned long*abits = new unsigned long[2*nw];
+      unsigned long*bbits = abits + nw;
+      for (unsigned idx = 0 ;  idx < 2*nw ;  idx += 1)
+	    abits[idx] = 0;
+
+      if (shift < len) {
+	    unsigned cnt = min(that.len(), len - shift);
+	    set_field(abits, shift, that.abits_words(), cnt);
+	    set_field(bbits, shift, that.bbits_words(), cnt);
+      }
+
+      verinum result(abits, bbits, len, has_len_flag);
       result.has_sign(that.has_sign());
 
-      for (unsigned idx = shift ;  idx < len ;  idx += 1)
-	    result.set(idx, that.get(idx - shift));
+      delete[]abits;
 
       return trim_vnum(result);
 }
@@ -1335,85 +1540,161 @@ verinum operator >> (const verinum&that, unsigned shift)
       }
 
       if (!has_len_flag) len -= shift;
-      verinum result(sign_bit, len, has_len_flag);
+
+	// Fill with the sign bit, then copy the remaining bits
+	// into the bottom.
+      unsigned cnt = that.len() - shift;
+      unsigned nw = words_for(len);
+      unsigned long*abits = new unsigned long[4*nw];
+      unsigned long*bbits = abits + nw;
+      unsigned long*tmp = bbits + nw;
+      fill_field(abits, 0, nw*BPW, v_abit(sign_bit));
+      fill_field(bbits, 0, nw*BPW, v_bbit(sign_bit));
+
+      get_field(tmp, that.abits_words(), shift, cnt);
+      set_field(abits, 0, tmp, cnt);
+      get_field(tmp, that.bbits_words(), shift, cnt);
+      set_field(bbits, 0, tmp, cnt);
+
+      verinum result(abits, bbits, len, has_len_flag);
       result.has_sign(that.has_sign());
 
-      for (unsigned idx = shift ;  idx < that.len() ;  idx += 1)
-	    result.set(idx-shift, that.get(idx));
+      delete[]abits;
 
       return trim_vnum(result);
 }
 
-static verinum unsigned_divide(verinum num, verinum den, bool signed_result)
+/*
+ * Divide the unsigned nbits wide num by den with binary long division,
+ * each step shifting and subtracting whole words. The quo and rem
+ * arrays get the quotient and the remainder, and have nw words, where
+ * nw is the number of words needed for nbits.
+ */
+static void divide_words(const unsigned long*num, const unsigned long*den,
+			 unsigned nbits, unsigned long*quo, unsigned long*rem)
 {
-	// We need the following calculations to be lossless. The
-	// result will be cast to the required width by the caller.
-      num.has_len(false);
-      den.has_len(false);
+      unsigned nw = words_for(nbits);
+      for (unsigned idx = 0 ;  idx < nw ;  idx += 1) {
+	    quo[idx] = 0;
+	    rem[idx] = 0;
+      }
+
+      for (unsigned bit = nbits ;  bit > 0 ;  bit -= 1) {
+	      // Shift the next bit of the numerator into the remainder.
+	    unsigned long out = 0;
+	    for (unsigned idx = 0 ;  idx < nw ;  idx += 1) {
+		  unsigned long word = rem[idx];
+		  rem[idx] = (word << 1) | out;
+		  out = word >> (BPW-1);
+	    }
+	    rem[0] |= word_bit(num, bit-1)? 1UL : 0UL;
+
+	      // The remainder is always less than the denominator
+	      // before the shift, so if a bit was shifted out it is
+	      // certainly larger now.
+	    bool ge = out != 0;
+	    if (! ge) {
+		  ge = true;
+		  for (unsigned idx = nw ;  idx > 0 ;  idx -= 1) {
+			if (rem[idx-1] == den[idx-1])
+			      continue;
+			ge = rem[idx-1] > den[idx-1];
+			break;
+		  }
+	    }
+	    if (! ge)
+		  continue;
+
+	    unsigned long borrow = 0;
+	    for (unsigned idx = 0 ;  idx < nw ;  idx += 1) {
+		  unsigned long dif = rem[idx] - den[idx];
+		  unsigned long b1 = rem[idx] < den[idx];
+		  unsigned long b2 = dif < borrow;
+		  rem[idx] = dif - borrow;
+		  borrow = b1 | b2;
+	    }
+	    quo[(bit-1)/BPW] |= 1UL << ((bit-1)%BPW);
+      }
+}
 
-      unsigned nwid = num.len();
-      while (nwid > 0 && (num.get(nwid-1) == verinum::V0))
-	    nwid -= 1;
+/*
+ * Return the number of bits of the unsigned value below the most
+ * significant 1 bit, inclusive.
+ */
+static unsigned unsigned_width(const verinum&val)
+{
+      const unsigned long*words = val.abits_words();
+      unsigned nw = words_for(val.len());
+      while (nw > 0 && words[nw-1] == 0)
+	    nw -= 1;
+      if (nw == 0)
+	    return 0;
 
-      unsigned dwid = den.len();
-      while (dwid > 0 && (den.get(dwid-1) == verinum::V0))
-	    dwid -= 1;
+      unsigned wid = nw * BPW;
+      while (! word_bit(words, wid-1))
+	    wid -= 1;
+      return wid;
+}
 
-      if (dwid > nwid)
+/*
+ * Divide the defined, unsigned values num and den. The quotient or
+ * the remainder is returned, depending on the want_rem flag.
+ */
+static verinum unsigned_divmod(const verinum&num, const verinum&den,
+			       bool want_rem, bool signed_result)
+{
+      unsigned nwid = unsigned_width(num);
+      unsigned dwid = unsigned_width(den);
+
+      if (dwid > nwid) {
+	    if (want_rem) {
+		  verinum res (num);
+		  res.has_len(false);
+		  return res;
+	    }
 	    return verinum(verinum::V0, 1);
+      }
 
-      den = den << (nwid-dwid);
-
-      unsigned idx = nwid - dwid + 1;
-      verinum result (verinum::V0, signed_result ? idx + 1 : idx);
-      if (signed_result) {
-	    result.set(idx, verinum::V0);
-	    result.has_sign(true);
+	// Make room for the sign bit of a signed quotient, and for
+	// a remainder as wide as the numerator.
+      unsigned nw = words_for(max(nwid+1, num.len()));
+      unsigned long*buf = new unsigned long[4*nw];
+      unsigned long*nbuf = buf;
+      unsigned long*dbuf = nbuf + nw;
+      unsigned long*quo = dbuf + nw;
+      unsigned long*rem = quo + nw;
+      for (unsigned idx = 0 ;  idx < nw ;  idx += 1) {
+	    nbuf[idx] = ext_word(num.abits_words(), nwid, idx, false);
+	    dbuf[idx] = ext_word(den.abits_words(), dwid, idx, false);
       }
-      while (idx > 0) {
-	    if (den <= num) {
-		  verinum dif = num - den;
-		  num = dif;
-		  result.set(idx-1, verinum::V1);
-	    }
-	    den = den >> 1;
-	    idx -= 1;
+      divide_words(nbuf, dbuf, nwid, quo, rem);
+      for (unsigned idx = words_for(nwid) ;  idx < nw ;  idx += 1) {
+	    quo[idx] = 0;
+	    rem[idx] = 0;
+      }
+
+      verinum result;
+      if (want_rem) {
+	    result = verinum(rem, 0, num.len(), false);
+      } else {
+	    unsigned idx = nwid - dwid + 1;
+	    result = verinum(quo, 0, signed_result ? idx + 1 : idx);
+	    result.has_sign(signed_result);
       }
 
+      delete[]buf;
       return result;
 }
 
-static verinum unsigned_modulus(verinum num, verinum den)
+static verinum unsigned_divide(const verinum&num, const verinum&den,
+			       bool signed_result)
 {
-	// We need the following calculations to be lossless. The
-	// result will be cast to the required width by the caller.
-      num.has_len(false);
-      den.has_len(false);
-
-      unsigned nwid = num.len();
-      while (nwid > 0 && (num.get(nwid-1) == verinum::V0))
-	    nwid -= 1;
-
-      unsigned dwid = den.len();
-      while (dwid > 0 && (den.get(dwid-1) == verinum::V0))
-	    dwid -= 1;
-
-      if (dwid > nwid)
-	    return num;
-
-      den = den << (nwid-dwid);
-
-      unsigned idx = nwid - dwid + 1;
-      while (idx > 0) {
-	    if (den <= num) {
-		  verinum dif = num - den;
-		  num = dif;
-	    }
-	    den = den >> 1;
-	    idx -= 1;
-      }
+      return unsigned_divmod(num, den, false, signed_result);
+}
 
-      return num;
+static verinum unsigned_modulus(const verinum&num, const verinum&den)
+{
+      return unsigned_divmod(num, den, true, false);
 }
 
 /*
@@ -1445,10 +1726,8 @@ verinum operator / (const verinum&left, const verinum&right)
 		  long l = left.as_long();
 		  long r = right.as_long();
 		  long v = l / r;
-		  for (unsigned idx = 0 ;  idx < use_len ;  idx += 1) {
-			result.set(idx,  (v & 1)? verinum::V1 : verinum::V0);
-			v >>= 1;
-		  }
+		  result = verinum((uint64_t)v, use_len);
+		  result.has_len(has_len_flag);
 
 	    } else {
 		  verinum use_left, use_right;
@@ -1479,10 +1758,8 @@ verinum operator / (const verinum&left, const verinum&right)
 		  unsigned long l = left.as_ulong();
 		  unsigned long r = right.as_ulong();
 		  unsigned long v = l / r;
-		  for (unsigned idx = 0 ;  idx < use_len ;  idx += 1) {
-			result.set(idx,  (v & 1)? verinum::V1 : verinum::V0);
-			v >>= 1;
-		  }
+		  result = verinum((uint64_t)v, use_len);
+		  result.has_len(has_len_flag);
 
 	    } else {
 		  result = unsigned_divide(left, right, false);
@@ -1519,10 +1796,8 @@ verinum operator % (const verinum&left, const verinum&right)
 		  long l = left.as_long();
 		  long r = right.as_long();
 		  long v = l % r;
-		  for (unsigned idx = 0 ;  idx < use_len ;  idx += 1) {
-			result.set(idx,  (v & 1)? verinum::V1 : verinum::V0);
-			v >>= 1;
-		  }
+		  result = verinum((uint64_t)v, use_len);
+		  result.has_len(has_len_flag);
 	    } else {
 		  verinum use_left, use_right;
 		  bool negative = false;
@@ -1548,10 +1823,8 @@ verinum operator % (const verinum&left, const verinum&right)
 		  unsigned long l = left.as_ulong();
 		  unsigned long r = right.as_ulong();
 		  unsigned long v = l % r;
-		  for (unsigned idx = 0 ;  idx < use_len ;  idx += 1) {
-			result.set(idx,  (v & 1)? verinum::V1 : verinum::V0);
-			v >>= 1;
-		  }
+		  result = verinum((uint64_t)v, use_len);
+		  result.has_len(has_len_flag);
 	    } else {
 		  result = unsigned_modulus(left, right);
 	    }
@@ -1573,11 +1846,8 @@ verinum concat(const verinum&left, const verinum&right)
       }
 
       verinum res (verinum::V0, left.len() + right.len());
-      for (unsigned idx = 0 ;  idx < right.len() ;  idx += 1)
-	    res.set(idx, right.get(idx));
-
-      for (unsigned idx = 0 ;  idx < left.len() ;  idx += 1)
-	    res.set(idx+right.len(), left.get(idx));
+      res.set(0, right);
+      res.set(right.len(), left);
 
       return res;
 }
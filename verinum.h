@@ -35,6 +35,13 @@ using namespace std;
  * possible values: 0, 1, x or z. The verinum number is store in
  * little-endian format. This means that if the long value is 2b'10,
  * get(0) is 0 and get(1) is 1.
+ *
+ * The bits are packed into two planes of words, the same way as the
+ * vvp_vector4_t in the run time. The abits plane holds the value and
+ * the bbits plane marks x and z bits, so that 0=(0,0), 1=(1,0),
+ * z=(0,1) and x=(1,1). The unused bits of the top words are always
+ * zero, and a number with no bbits set is fully defined, so that the
+ * arithmetic can work a word at a time.
  */
 class verinum {
 
@@ -44,6 +51,10 @@ class verinum {
       verinum();
       explicit verinum(const string&str);
       verinum(const V*v, unsigned nbits, bool has_len =true);
+	// Make a number from word planes. If bbits is nil, the number
+	// is fully defined.
+      verinum(const unsigned long*abits, const unsigned long*bbits,
+	      unsigned nbits, bool has_len =true);
       explicit verinum(V, unsigned nbits =1, bool has_len =true);
       verinum(uint64_t val, unsigned bits);
       verinum(double val, bool);
@@ -100,6 +111,14 @@ class verinum {
 
       V operator[] (unsigned idx) const { return get(idx); }
 
+	// Direct read access to the word planes. Each plane has
+	// nwords() words.
+      unsigned nwords() const { return (nbits_ + BITS_PER_WORD - 1) / BITS_PER_WORD; }
+      const unsigned long* abits_words() const { return abits_; }
+      const unsigned long* bbits_words() const { return bbits_; }
+
+      static const unsigned BITS_PER_WORD = 8 * sizeof(unsigned long);
+
 	// Return the value as a native unsigned integer. If the value is
 	// larger than can be represented by the returned type, return
 	// the maximum value of that type. If the value has any x or z
@@ -112,10 +131,13 @@ class verinum {
       double as_double() const;
       string as_string() const;
     private:
+      void allocate_(unsigned nbits);
       void signed_trim();
 
     private:
-      V* bits_;
+	// The bbits_ plane is in the same allocation as abits_.
+      unsigned long*abits_;
+      unsigned long*bbits_;
       unsigned nbits_;
       bool has_len_;
       bool has_sign_;
@@ -43,7 +43,11 @@
 #include "fastlz.h"
 #include "lz4.h"
 
-#ifndef HAVE_LIBPTHREAD
+#ifdef HAVE_LIBPTHREAD
+#ifndef FST_WRITER_PARALLEL
+#define FST_WRITER_PARALLEL
+#endif
+#else
 #undef FST_WRITER_PARALLEL
 #endif
 
@@ -2496,6 +2500,33 @@ if(xc)
 }
 
 
+/*
+ * set the size of the value change block that is compressed and written
+ * out as one section, overriding the size picked from the amount of
+ * memory and the number of signals. only effective before any value
+ * changes are emitted. sizes above FST_BREAK_SIZE_MAX are clamped, as
+ * the value change buffer size is kept in 32 bits.
+ */
+void fstWriterSetBreakSize(void *ctx, uint64_t numbytes)
+{
+struct fstWriterContext *xc = (struct fstWriterContext *)ctx;
+if(xc && numbytes && (xc->vchg_siz <= 1))
+        {
+        if(numbytes > FST_BREAK_SIZE_MAX)
+                {
+                numbytes = FST_BREAK_SIZE_MAX;
+                }
+        xc->fst_break_size = xc->fst_orig_break_size = numbytes;
+        xc->fst_huge_break_size = numbytes; /* no further growth as signals are added */
+        xc->vchg_alloc_siz = xc->fst_break_size + xc->fst_break_add_size;
+        if(xc->vchg_mem)
+                {
+                xc->vchg_mem = realloc(xc->vchg_mem, xc->vchg_alloc_siz);
+                }
+        }
+}
+
+
 int fstWriterGetDumpSizeLimitReached(void *ctx)
 {
 struct fstWriterContext *xc = (struct fstWriterContext *)ctx;
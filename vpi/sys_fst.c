@@ -64,6 +64,23 @@ static enum lxm_optimum_mode_e {
       LXM_BOTH = 3
 } lxm_optimum_mode = LXM_NONE;
 
+/*
+ * The FST writer can compress and write each block of value changes
+ * in a background thread while the simulation fills the next block.
+ * This is on by default and can be turned off with +fst-threads=0. The
+ * +fst-block-size=N plusarg sets the size in bytes of these blocks.
+ */
+#ifdef HAVE_LIBPTHREAD
+static unsigned long fst_threads = 1;
+#else
+static unsigned long fst_threads = 0;
+#endif
+static unsigned long fst_block_size = 0;
+
+/* The largest block the FST writer supports (FST_BREAK_SIZE_MAX in
+   fstapi.c). Its value change buffer size is a 32 bit number. */
+#define FST_BLOCK_SIZE_MAX (1UL << 31)
+
 static const char*units_names[] = {
       "s",
       "ms",
@@ -202,6 +219,7 @@ static PLI_INT32 dumpvars_cb(p_cb_data cause)
       if (dumpvars_status != 1) return 0;
 
       dumpvars_status = 2;
+      vcd_dump_filter_report("FST");
 
       dumpvars_time = timerec_to_time64(cause->time);
       vcd_cur_time = dumpvars_time;
@@ -412,7 +430,31 @@ static void open_dumpfile(vpiHandle callh)
 	        (lxm_optimum_mode == LXM_BOTH)) {
 		  fstWriterSetRepackOnClose(dump_file, 1);
 	    }
+	    if (fst_block_size > 0) {
+		  fstWriterSetBreakSize(dump_file, fst_block_size);
+	    }
+#ifdef HAVE_LIBPTHREAD
+	    if (fst_threads > 0) {
+		  fstWriterSetParallelMode(dump_file, 1);
+	    }
+#endif
+      }
+}
+
+/* Get the number after the first len characters of a plusarg, and
+   return 0 if it is not valid. */
+static int get_plusarg_number(const char*arg, size_t len, unsigned long*res)
+{
+      char*ep;
+      unsigned long val = strtoul(arg+len, &ep, 0);
+
+      if (arg[len] == 0 || *ep != 0) {
+	    vpi_printf("FST warning: Ignoring invalid argument %s.\n", arg);
+	    return 0;
       }
+
+      *res = val;
+      return 1;
 }
 
 static PLI_INT32 sys_dumpfile_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
@@ -588,6 +630,7 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 	      /* If we are skipping all signal or this is in an automatic
 	       * scope then just return. */
             if (skip || vpi_get(vpiAutomatic, item)) return;
+	    if (vcd_dump_filter_skip(fullname)) return;
 
 	      /* Skip this signal if it has already been included.
 	       * This can only happen for implicitly given signals. */
@@ -915,9 +958,41 @@ void sys_fst_register(void)
 		  lxm_optimum_mode = LXM_BOTH;
 	    } else if (strcmp(vlog_info.argv[idx],"-fst-speed-space") == 0) {
 		  lxm_optimum_mode = LXM_BOTH;
+
+	    } else if (strncmp(vlog_info.argv[idx],"+fst-threads=",13) == 0) {
+		  get_plusarg_number(vlog_info.argv[idx], 13, &fst_threads);
+
+	    } else if (strncmp(vlog_info.argv[idx],"+fst-block-size=",16) == 0) {
+		  unsigned long val;
+		  if (! get_plusarg_number(vlog_info.argv[idx], 16, &val)) {
+			/* Already reported. */
+		  } else if (val == 0) {
+			vpi_printf("FST warning: Ignoring %s, the block "
+			           "size must be more than 0.\n",
+			           vlog_info.argv[idx]);
+		  } else if (val > FST_BLOCK_SIZE_MAX) {
+			vpi_printf("FST warning: %s is too large, using "
+			           "the largest block size (%lu bytes).\n",
+			           vlog_info.argv[idx], FST_BLOCK_SIZE_MAX);
+			fst_block_size = FST_BLOCK_SIZE_MAX;
+		  } else {
+			fst_block_size = val;
+		  }
 	    }
       }
 
+#ifdef HAVE_LIBPTHREAD
+	/* The FST writer compresses one block at a time, so there is
+	   never a use for more than one background thread. */
+      if (fst_threads > 1) fst_threads = 1;
+#else
+      if (fst_threads > 0) {
+	    vpi_printf("FST warning: Background compression is not "
+	               "supported on this platform.\n");
+	    fst_threads = 0;
+      }
+#endif
+
       /* All the compiletf routines are located in vcd_priv.c. */
 
       tf_data.type      = vpiSysTask;
@@ -281,6 +281,7 @@ static PLI_INT32 dumpvars_cb(p_cb_data cause)
       if (dumpvars_status != 1) return 0;
 
       dumpvars_status = 2;
+      vcd_dump_filter_report("LXT");
 
       dumpvars_time = timerec_to_time64(cause->time);
       vcd_cur_time = dumpvars_time;
@@ -570,6 +571,7 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
             }
 
             if (skip || vpi_get(vpiAutomatic, item)) break;
+	    if (vcd_dump_filter_skip(vpi_get_str(vpiFullName, item))) break;
 
 	    name = vpi_get_str(vpiName, item);
 	    nexus_id = vpi_get(_vpiNexusId, item);
@@ -621,6 +623,7 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 	  case vpiRealVar:
 
             if (skip || vpi_get(vpiAutomatic, item)) break;
+	    if (vcd_dump_filter_skip(vpi_get_str(vpiFullName, item))) break;
 
 	    name = vpi_get_str(vpiName, item);
 	    { char*tmp = create_full_name(name);
@@ -321,6 +321,7 @@ static PLI_INT32 dumpvars_cb(p_cb_data cause)
       if (dumpvars_status != 1) return 0;
 
       dumpvars_status = 2;
+      vcd_dump_filter_report("LXT2");
 
       dumpvars_time = timerec_to_time64(cause->time);
       vcd_cur_time = dumpvars_time;
@@ -630,6 +631,7 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
             }
 
             if (skip || vpi_get(vpiAutomatic, item)) break;
+	    if (vcd_dump_filter_skip(vpi_get_str(vpiFullName, item))) break;
 
 	    name = vpi_get_str(vpiName, item);
 	    nexus_id = vpi_get(_vpiNexusId, item);
@@ -677,6 +679,7 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 	  case vpiRealVar:
 
             if (skip || vpi_get(vpiAutomatic, item)) break;
+	    if (vcd_dump_filter_skip(vpi_get_str(vpiFullName, item))) break;
 
 	    name = vpi_get_str(vpiName, item);
 	    { char*tmp = create_full_name(name);
@@ -858,6 +861,7 @@ static void* lxt2_thread(void*arg)
 
 	    switch (cell->type) {
 		case WT_NONE:
+		case WT_EMIT_VECTOR:
 		  break;
 		case WT_FLUSH:
 		  lxt2_wr_flush(dump_file);
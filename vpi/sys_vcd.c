@@ -41,6 +41,8 @@ struct vcd_info {
       vpiHandle cb;
       struct t_vpi_time time;
       const char *ident;
+      PLI_INT32 type;
+      unsigned size;
       struct vcd_info *next;
       struct vcd_info *dmp_next;
       int scheduled;
@@ -85,56 +87,212 @@ static void gen_new_vcd_id(void)
       assert(0);
 }
 
-static char *truncate_bitvec(char *s)
+/*
+ * The value changes are formatted into this buffer, which is written
+ * to the dump file when it fills. Whoever owns the dump file owns the
+ * buffer too, so the simulation thread drains it (in vcd_sync) before
+ * it writes to the dump file directly.
+ */
+static char vcd_buf[64*1024];
+static size_t vcd_buf_fill = 0;
+
+static void vcd_buf_drain(void)
+{
+      if (vcd_buf_fill == 0) return;
+      fwrite(vcd_buf, 1, vcd_buf_fill, dump_file);
+      vcd_buf_fill = 0;
+}
+
+/* Make room for len (a small number) more characters in the buffer. */
+static char*vcd_buf_reserve(size_t len)
+{
+      if (vcd_buf_fill + len > sizeof vcd_buf) vcd_buf_drain();
+      return vcd_buf + vcd_buf_fill;
+}
+
+static void vcd_buf_put(const char*str, size_t len)
+{
+      if (len > sizeof vcd_buf) {
+	    vcd_buf_drain();
+	    fwrite(str, 1, len, dump_file);
+	    return;
+      }
+      memcpy(vcd_buf_reserve(len), str, len);
+      vcd_buf_fill += len;
+}
+
+static void vcd_buf_put_ident(const char*ident)
+{
+      size_t len = strlen(ident);
+      char*cp = vcd_buf_reserve(len+1);
+      memcpy(cp, ident, len);
+      cp[len] = '\n';
+      vcd_buf_fill += len+1;
+}
+
+static void vcd_sync(void)
+{
+      vcd_work_sync();
+      vcd_buf_drain();
+}
+
+/*
+ * Each entry of this table holds the 8 characters for a byte of aval
+ * bits, most significant bit first. Bytes that have any bval bits set
+ * are patched up bit by bit.
+ */
+static char vcd_byte_bits[256][8];
+
+static void vcd_init_byte_bits(void)
+{
+      unsigned idx, bit;
+      for (idx = 0 ;  idx < 256 ;  idx += 1) {
+	    for (bit = 0 ;  bit < 8 ;  bit += 1)
+		  vcd_byte_bits[idx][bit] = (idx >> (7-bit)) & 1 ? '1' : '0';
+      }
+}
+
+#define VCD_WORD_BITS (8*sizeof(unsigned long))
+
+static __inline__ char vector_bit(const unsigned long*aval,
+                                  const unsigned long*bval, unsigned idx)
+{
+      unsigned word = idx / VCD_WORD_BITS;
+      unsigned shift = idx % VCD_WORD_BITS;
+      unsigned ab = ((aval[word] >> shift) & 1) |
+                    (((bval[word] >> shift) & 1) << 1);
+      return "01zx"[ab];
+}
+
+/*
+ * Write a raw vector value change (see s_vpi_rawval) to the buffer. A
+ * vector of width 1 is a scalar, and otherwise the leading bits are
+ * compressed the way the VCD format allows: leading 0 bits before a 1
+ * are dropped, and a run of leading x, z or 0 bits is reduced to one
+ * bit.
+ */
+static void write_vector(unsigned wid, const unsigned long*aval,
+                         const unsigned long*bval, const char*ident)
 {
-      char r;
+      unsigned idx;
+      char*cp;
+      char lead;
+
+      if (wid == 1) {
+	    cp = vcd_buf_reserve(1);
+	    *cp = vector_bit(aval, bval, 0);
+	    vcd_buf_fill += 1;
+	    vcd_buf_put_ident(ident);
+	    return;
+      }
 
-      r=*s;
-      if(r=='1') return s;
-      else s += 1;
+	/* Find the first bit after the leading run. */
+      idx = wid - 1;
+      lead = vector_bit(aval, bval, idx);
+      if (lead != '1') {
+	    while (idx > 0 && vector_bit(aval, bval, idx-1) == lead)
+		  idx -= 1;
+	    if (idx > 0 && lead == '0' && vector_bit(aval, bval, idx-1) == '1')
+		  idx -= 1;
+      }
 
-      for(;;s++) {
-	    char l;
-	    l=r; r=*s;
-	    if(!r) return (s-1);
-	    if(l!=r) return(((l=='0')&&(r=='1'))?s:s-1);
+	/* Now idx is the most significant bit to write. */
+      vcd_buf_put("b", 1);
+      idx += 1;
+      while (idx > 0) {
+	    if (idx % 8 != 0 || bval[(idx-1)/VCD_WORD_BITS] != 0) {
+		    /* Write bits one at a time up to a byte boundary,
+		       or across a word with x or z bits in it. */
+		  cp = vcd_buf_reserve(1);
+		  *cp = vector_bit(aval, bval, idx-1);
+		  vcd_buf_fill += 1;
+		  idx -= 1;
+	    } else {
+		  unsigned word = (idx-8) / VCD_WORD_BITS;
+		  unsigned shift = (idx-8) % VCD_WORD_BITS;
+		  cp = vcd_buf_reserve(8);
+		  memcpy(cp, vcd_byte_bits[(aval[word] >> shift) & 0xff], 8);
+		  vcd_buf_fill += 8;
+		  idx -= 8;
+	    }
       }
+      vcd_buf_put(" ", 1);
+      vcd_buf_put_ident(ident);
+}
+
+static void write_real(double val, const char*ident)
+{
+      char*cp = vcd_buf_reserve(32);
+      vcd_buf_fill += snprintf(cp, 32, "r%.16g ", val);
+      vcd_buf_put_ident(ident);
+}
+
+static void write_time(PLI_UINT64 now)
+{
+      char*cp = vcd_buf_reserve(32);
+      vcd_buf_fill += snprintf(cp, 32, "#%" PLI_UINT64_FMT "\n", now);
 }
 
+/*
+ * Named events are written as a change to 1, and everything that is
+ * not a real is fetched in the raw format, which points at the bits
+ * of the signal instead of converting them.
+ */
+static const unsigned long vcd_event_words[2] = { 1, 0 };
+static const s_vpi_rawval vcd_event_value = { 1, vcd_event_words,
+                                              vcd_event_words+1 };
+
 static void show_this_item(struct vcd_info*info)
 {
       s_vpi_value value;
-      PLI_INT32 type = vpi_get(vpiType, info->item);
 
-      if (type == vpiRealVar) {
+      if (info->type == vpiRealVar) {
 	    value.format = vpiRealVal;
 	    vpi_get_value(info->item, &value);
-	    fprintf(dump_file, "r%.16g %s\n", value.value.real, info->ident);
-      } else if (type == vpiNamedEvent) {
-	    fprintf(dump_file, "1%s\n", info->ident);
-      } else if (vpi_get(vpiSize, info->item) == 1) {
-	    value.format = vpiBinStrVal;
+	    write_real(value.value.real, info->ident);
+      } else if (info->type == vpiNamedEvent) {
+	    write_vector(1, vcd_event_value.aval, vcd_event_value.bval,
+	                 info->ident);
+      } else {
+	    const s_vpi_rawval*raw;
+	    value.format = _vpiRawFourStateVal;
+	    vpi_get_value(info->item, &value);
+	    raw = (const s_vpi_rawval*)value.value.misc;
+	    write_vector(raw->width, raw->aval, raw->bval, info->ident);
+      }
+}
+
+/*
+ * This is the same as show_this_item, but it sends the value to the
+ * work thread to be written instead of writing it here.
+ */
+static void queue_this_item(struct vcd_info*info)
+{
+      s_vpi_value value;
+
+      if (info->type == vpiRealVar) {
+	    value.format = vpiRealVal;
 	    vpi_get_value(info->item, &value);
-	    fprintf(dump_file, "%s%s\n", value.value.str, info->ident);
+	    vcd_work_emit_ident_double(info->ident, value.value.real);
+      } else if (info->type == vpiNamedEvent) {
+	    vcd_work_emit_ident_raw(info->ident, &vcd_event_value);
       } else {
-	    value.format = vpiBinStrVal;
+	    value.format = _vpiRawFourStateVal;
 	    vpi_get_value(info->item, &value);
-	    fprintf(dump_file, "b%s %s\n", truncate_bitvec(value.value.str),
-		    info->ident);
+	    vcd_work_emit_ident_raw(info->ident,
+	                            (const s_vpi_rawval*)value.value.misc);
       }
 }
 
 /* Dump values for a $dumpoff. */
 static void show_this_item_x(struct vcd_info*info)
 {
-      PLI_INT32 type = vpi_get(vpiType, info->item);
-
-      if (type == vpiRealVar) {
+      if (info->type == vpiRealVar) {
 	      /* Some tools dump nothing here...? */
 	    fprintf(dump_file, "rNaN %s\n", info->ident);
-      } else if (type == vpiNamedEvent) {
+      } else if (info->type == vpiNamedEvent) {
 	    /* Do nothing for named events. */
-      } else if (vpi_get(vpiSize, info->item) == 1) {
+      } else if (info->size == 1) {
 	    fprintf(dump_file, "x%s\n", info->ident);
       } else {
 	    fprintf(dump_file, "bx %s\n", info->ident);
@@ -167,6 +325,7 @@ static void vcd_checkpoint(void)
 
       for (cur = vcd_list ;  cur ;  cur = cur->next)
 	    show_this_item(cur);
+      vcd_buf_drain();
 }
 
 static void vcd_checkpoint_x(void)
@@ -177,18 +336,86 @@ static void vcd_checkpoint_x(void)
 	    show_this_item_x(cur);
 }
 
+/*
+ * The value changes are formatted and written by the work thread. The
+ * work thread owns the dump file, the output buffer and vcd_cur_time
+ * while it has work queued, so the simulation thread calls vcd_sync()
+ * before it touches any of them.
+ */
+static void* vcd_thread(void*arg)
+{
+      int run_flag = 1;
+
+      (void)arg; /* Parameter is not used. */
+
+      while (run_flag) {
+	    struct vcd_work_item_s*cell = vcd_work_thread_peek();
+
+	    switch (cell->type) {
+		case WT_EMIT_DOUBLE:
+		case WT_EMIT_VECTOR:
+		  if (cell->time != vcd_cur_time) {
+			write_time(cell->time);
+			vcd_cur_time = cell->time;
+		  }
+		  if (cell->type == WT_EMIT_DOUBLE)
+			write_real(cell->op_.val_double, cell->sym_.ident);
+		  else
+			write_vector(cell->wid, cell->op_.val_words,
+			             cell->op_.val_words
+			             + (cell->wid+VCD_WORD_BITS-1)/VCD_WORD_BITS,
+			             cell->sym_.ident);
+		  break;
+		case WT_FLUSH:
+		  vcd_buf_drain();
+		  fflush(dump_file);
+		  break;
+		case WT_TERMINATE:
+		  vcd_buf_drain();
+		  run_flag = 0;
+		  break;
+		default:
+		  break;
+	    }
+
+	    vcd_work_thread_pop();
+      }
+
+      return 0;
+}
+
+/*
+ * The dump file limit is checked against the size of the file, so the
+ * values still in the work queue and the output buffer must be written
+ * out first. That is done here, once for each time step that has value
+ * changes, and only if there is a limit.
+ */
+static int dump_limit_exceeded(void)
+{
+      if (dump_limit <= 0) return 0;
+
+      vcd_sync();
+      if (ftell(dump_file) <= dump_limit) return 0;
+
+      vpi_printf("WARNING: Dump file limit (%ld bytes) "
+                         "exceeded.\n", dump_limit);
+      fprintf(dump_file, "$comment Dump file limit (%ld bytes) "
+                         "exceeded. $end\n", dump_limit);
+      return 1;
+}
+
 static PLI_INT32 variable_cb_2(p_cb_data cause)
 {
       struct vcd_info* info = vcd_dmp_list;
-      PLI_UINT64 now = timerec_to_time64(cause->time);
 
-      if (now != vcd_cur_time) {
-	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", now);
-	    vcd_cur_time = now;
-      }
+      if (!dump_is_full && dump_limit_exceeded())
+            dump_is_full = 1;
+
+      if (!dump_is_full)
+            vcd_work_set_time(timerec_to_time64(cause->time));
 
       do {
-           show_this_item(info);
+           if (!dump_is_full) queue_this_item(info);
            info->scheduled = 0;
       } while ((info = info->dmp_next) != 0);
 
@@ -207,15 +434,6 @@ static PLI_INT32 variable_cb_1(p_cb_data cause)
       if (dump_header_pending()) return 0;
       if (info->scheduled) return 0;
 
-      if ((dump_limit > 0) && (ftell(dump_file) > dump_limit)) {
-            dump_is_full = 1;
-            vpi_printf("WARNING: Dump file limit (%ld bytes) "
-                               "exceeded.\n", dump_limit);
-            fprintf(dump_file, "$comment Dump file limit (%ld bytes) "
-                               "exceeded. $end\n", dump_limit);
-            return 0;
-      }
-
       if (!vcd_dmp_list) {
           cb = *cause;
 	  cb.time = &zero_delay;
@@ -236,8 +454,10 @@ static PLI_INT32 dumpvars_cb(p_cb_data cause)
       if (dumpvars_status != 1) return 0;
 
       dumpvars_status = 2;
+      vcd_dump_filter_report("VCD");
 
       dumpvars_time = timerec_to_time64(cause->time);
+      vcd_sync();
       vcd_cur_time = dumpvars_time;
 
       fprintf(dump_file, "$enddefinitions $end\n");
@@ -261,11 +481,13 @@ static PLI_INT32 finish_cb(p_cb_data cause)
       finish_status = 1;
 
       dumpvars_time = timerec_to_time64(cause->time);
+      vcd_sync();
 
       if (!dump_is_off && !dump_is_full && dumpvars_time != vcd_cur_time) {
 	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", dumpvars_time);
       }
 
+      vcd_work_terminate();
       fclose(dump_file);
 
       for (cur = vcd_list ;  cur ;  cur = next) {
@@ -331,6 +553,7 @@ static PLI_INT32 sys_dumpoff_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       vpi_get_time(0, &now);
       now64 = timerec_to_time64(&now);
 
+      vcd_sync();
       if (now64 > vcd_cur_time) {
 	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", now64);
 	    vcd_cur_time = now64;
@@ -361,6 +584,7 @@ static PLI_INT32 sys_dumpon_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       vpi_get_time(0, &now);
       now64 = timerec_to_time64(&now);
 
+      vcd_sync();
       if (now64 > vcd_cur_time) {
 	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", now64);
 	    vcd_cur_time = now64;
@@ -388,6 +612,7 @@ static PLI_INT32 sys_dumpall_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       vpi_get_time(0, &now);
       now64 = timerec_to_time64(&now);
 
+      vcd_sync();
       if (now64 > vcd_cur_time) {
 	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", now64);
 	    vcd_cur_time = now64;
@@ -444,6 +669,9 @@ static void open_dumpfile(vpiHandle callh)
 	    fprintf(dump_file, "$timescale\n");
 	    fprintf(dump_file, "\t%u%s\n", scale, units_names[udx]);
 	    fprintf(dump_file, "$end\n");
+
+	    vcd_init_byte_bits();
+	    vcd_work_start(vcd_thread, 0);
       }
 }
 
@@ -485,7 +713,10 @@ static PLI_INT32 sys_dumpfile_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 static PLI_INT32 sys_dumpflush_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 {
       (void)name; /* Parameter is not used. */
-      if (dump_file) fflush(dump_file);
+      if (dump_file) {
+	    vcd_sync();
+	    fflush(dump_file);
+      }
 
       return 0;
 }
@@ -617,6 +848,7 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 	      /* If we are skipping all signal or this is in an automatic
 	       * scope then just return. */
             if (skip || vpi_get(vpiAutomatic, item)) return;
+	    if (vcd_dump_filter_skip(fullname)) return;
 
 	      /* Skip this signal if it has already been included.
 	       * This can only happen for implicitly given signals. */
@@ -644,6 +876,9 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 		  info->time.type = vpiSimTime;
 		  info->item  = item;
 		  info->ident = ident;
+		  info->type  = vpi_get(vpiType, item);
+		  info->size  = info->type == vpiNamedEvent ? 1 :
+		                vpi_get(vpiSize, item);
 		  info->scheduled = 0;
 
 		  cb.time      = &info->time;
@@ -130,6 +130,163 @@ void vcd_names_sort(struct vcd_names_list_s*tab)
       }
 }
 
+static char**dump_filter_list = 0;
+static unsigned dump_filter_count = 0;
+static int dump_filter_loaded = 0;
+
+/*
+ * The names of the signals kept and skipped by the filter. A signal
+ * can be reached more than once by overlapping $dumpvars scopes, so
+ * the names are saved and only the distinct names are counted.
+ */
+struct dump_filter_names_s {
+      char**names;
+      unsigned long count;
+};
+static struct dump_filter_names_s dump_filter_kept = {0, 0};
+static struct dump_filter_names_s dump_filter_skipped = {0, 0};
+
+static void dump_filter_names_add(struct dump_filter_names_s*tab,
+                                  const char*name)
+{
+      tab->names = (char**)realloc(tab->names,
+                                   (tab->count+1)*sizeof(char*));
+      tab->names[tab->count++] = strdup(name);
+}
+
+static int dump_filter_names_compare(const void*s1, const void*s2)
+{
+      const char*v1 = *(const char* const*) s1;
+      const char*v2 = *(const char* const*) s2;
+
+      return strcmp(v1, v2);
+}
+
+/*
+ * Return the number of distinct names in the table, and empty it.
+ */
+static unsigned long dump_filter_names_flush(struct dump_filter_names_s*tab)
+{
+      unsigned long idx, res = 0;
+
+      qsort(tab->names, tab->count, sizeof(char*), dump_filter_names_compare);
+      for (idx = 0 ;  idx < tab->count ;  idx += 1) {
+	    if (idx == 0 || strcmp(tab->names[idx-1], tab->names[idx]) != 0)
+		  res += 1;
+      }
+      for (idx = 0 ;  idx < tab->count ;  idx += 1)
+	    free(tab->names[idx]);
+      free(tab->names);
+      tab->names = 0;
+      tab->count = 0;
+
+      return res;
+}
+
+static void dump_filter_load(void)
+{
+      struct t_vpi_vlog_info vlog_info;
+      const char*path = 0;
+      char line[4096];
+      FILE*fd;
+      int idx;
+
+      dump_filter_loaded = 1;
+
+      vpi_get_vlog_info(&vlog_info);
+      for (idx = 0 ;  idx < vlog_info.argc ;  idx += 1) {
+	    if (strncmp(vlog_info.argv[idx], "+dumpfilter=", 12) == 0)
+		  path = vlog_info.argv[idx] + 12;
+      }
+      if (path == 0) return;
+
+      fd = fopen(path, "r");
+      if (fd == 0) {
+	    vpi_printf("WARNING: Unable to open dump filter file %s, "
+	               "dumping all signals.\n", path);
+	    return;
+      }
+
+      while (fgets(line, sizeof line, fd)) {
+	    char*cp = line;
+	    char*ep;
+	    while (isspace((int)*cp)) cp += 1;
+	    ep = cp + strlen(cp);
+	    while (ep > cp && isspace((int)ep[-1])) ep -= 1;
+	    *ep = 0;
+	    if (*cp == 0 || *cp == '#') continue;
+
+	    dump_filter_list = (char**)realloc(dump_filter_list,
+	                       (dump_filter_count+1)*sizeof(char*));
+	    dump_filter_list[dump_filter_count++] = strdup(cp);
+      }
+      fclose(fd);
+
+      if (dump_filter_count == 0) {
+	    vpi_printf("WARNING: Dump filter file %s has no patterns, "
+	               "dumping all signals.\n", path);
+      }
+}
+
+/*
+ * Match a string against a pattern where '*' matches any string and
+ * '?' matches any character. When a '*' is followed by a mismatch,
+ * back up and let the most recent '*' match one more character.
+ */
+static int dump_filter_match(const char*pat, const char*str)
+{
+      const char*star_pat = 0;
+      const char*star_str = 0;
+
+      while (*str) {
+	    if (*pat == '*') {
+		  star_pat = ++pat;
+		  star_str = str;
+	    } else if (*pat == '?' || *pat == *str) {
+		  pat += 1;
+		  str += 1;
+	    } else if (star_pat) {
+		  pat = star_pat;
+		  str = ++star_str;
+	    } else {
+		  return 0;
+	    }
+      }
+
+      while (*pat == '*') pat += 1;
+      return *pat == 0;
+}
+
+int vcd_dump_filter_skip(const char*fullname)
+{
+      unsigned idx;
+
+      if (! dump_filter_loaded) dump_filter_load();
+      if (dump_filter_count == 0) return 0;
+
+      for (idx = 0 ;  idx < dump_filter_count ;  idx += 1) {
+	    if (dump_filter_match(dump_filter_list[idx], fullname)) {
+		  dump_filter_names_add(&dump_filter_kept, fullname);
+		  return 0;
+	    }
+      }
+
+      dump_filter_names_add(&dump_filter_skipped, fullname);
+      return 1;
+}
+
+void vcd_dump_filter_report(const char*dumper)
+{
+      unsigned long kept, skipped;
+
+      if (dump_filter_count == 0) return;
+
+      kept = dump_filter_names_flush(&dump_filter_kept);
+      skipped = dump_filter_names_flush(&dump_filter_skipped);
+      vpi_printf("%s info: +dumpfilter selected %lu and skipped %lu "
+                 "signals.\n", dumper, kept, skipped);
+}
+
 /*
  * Since the compiletf routines are all the same they are located here,
  * so we only need a single copy. Some are generic enough they can use
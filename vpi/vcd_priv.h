@@ -47,6 +47,21 @@ EXTERN void vcd_names_sort(struct vcd_names_list_s*tab);
 
 EXTERN void vcd_names_delete(struct vcd_names_list_s*tab);
 
+/*
+ * The +dumpfilter=<file> plusarg names a file of patterns, one per
+ * line, that select the signals to dump. Blank lines and lines that
+ * start with a '#' are ignored. A '*' in a pattern matches any string
+ * (including the '.' between scope names) and a '?' matches any one
+ * character. The scan_item functions of the dumpers call
+ * vcd_dump_filter_skip with the full name of each signal, and leave
+ * out the signal (and its value change callback) if it returns
+ * true. Without a +dumpfilter all signals are dumped.
+ *
+ * vcd_dump_filter_report prints how many signals were left out.
+ */
+EXTERN int  vcd_dump_filter_skip(const char*fullname);
+EXTERN void vcd_dump_filter_report(const char*dumper);
+
 /*
  * Keep a map of nexus ident's to help with alias detection.
  */
@@ -64,13 +79,17 @@ EXTERN void vcd_scope_names_delete(void);
 
 /*
  * Implement a work queue that can be used to send commands to a
- * dumper thread.
+ * dumper thread. The queue is a single producer, single consumer
+ * ring: the simulation thread adds items and the dumper thread
+ * removes them. The two sides only share an atomic fill count, so
+ * neither side takes a lock unless it must wait for the other.
  */
 
 typedef enum vcd_work_item_type_e {
       WT_NONE,
       WT_EMIT_BITS,
       WT_EMIT_DOUBLE,
+      WT_EMIT_VECTOR,
       WT_DUMPON,
       WT_DUMPOFF,
       WT_FLUSH,
@@ -79,17 +98,35 @@ typedef enum vcd_work_item_type_e {
 
 struct lxt2_wr_symbol;
 
+/*
+ * Short bit strings and vectors are copied into the inline_ buffer of
+ * the work item itself, and val_char or val_words points at that
+ * buffer. Longer values are copied to the heap, and freed when the
+ * item is popped. A WT_EMIT_VECTOR holds the aval words of a raw
+ * value (see s_vpi_rawval) followed by the bval words, and wid is its
+ * width in bits.
+ */
+#define VCD_WORK_BITS_INLINE 32
+
 struct vcd_work_item_s {
       vcd_work_item_type_t type;
+      unsigned wid;
       uint64_t time;
       union {
 	    struct lxt2_wr_symbol*lxt2;
+	    const char*ident;
       } sym_;
 
       union {
 	    double val_double;
 	    char*val_char;
+	    unsigned long*val_words;
       } op_;
+
+      union {
+	    char bits[VCD_WORK_BITS_INLINE];
+	    unsigned long words[VCD_WORK_BITS_INLINE/sizeof(unsigned long)];
+      } inline_;
 };
 
 /*
@@ -126,6 +163,14 @@ EXTERN void vcd_work_dumpoff(void);
 EXTERN void vcd_work_emit_double(struct lxt2_wr_symbol*sym, double val);
 EXTERN void vcd_work_emit_bits(struct lxt2_wr_symbol*sym, const char*bits);
 
+/*
+ * These are the same as the emit functions above, but for dumpers
+ * that identify their signals by an identifier string.
+ */
+EXTERN void vcd_work_emit_ident_double(const char*ident, double val);
+EXTERN void vcd_work_emit_ident_bits(const char*ident, const char*bits);
+EXTERN void vcd_work_emit_ident_raw(const char*ident, const s_vpi_rawval*val);
+
 /* The compiletf routines are common for the VCD, LXT and LXT2 dumpers. */
 EXTERN PLI_INT32 sys_dumpvars_compiletf(ICARUS_VPI_CONST PLI_BYTE8 *name);
 
@@ -89,8 +89,25 @@ static const unsigned WORK_QUEUE_SIZE = 128*1024;
 static const unsigned WORK_QUEUE_BATCH_MIN = 4*1024;
 static const unsigned WORK_QUEUE_BATCH_MAX = 32*1024;
 
+/*
+ * The work queue is a ring with a single producer (the simulation
+ * thread) and a single consumer (the work thread). The work_queue_next
+ * index belongs to the consumer and the work_queue_tail index belongs
+ * to the producer. The only thing the two threads share is the
+ * work_queue_fill count, which is changed with atomic operations. The
+ * producer adds items to the fill count, so the consumer may only see
+ * it grow, and the consumer removes them, so the producer may only see
+ * it shrink. That means each side can trust a stale value of the
+ * fill count, and only needs the mutex if it must sleep waiting for
+ * the other side.
+ *
+ * The atomic builtins are full memory barriers, so the contents of the
+ * work items are visible to the consumer before the fill count that
+ * includes them.
+ */
 static struct vcd_work_item_s work_queue[WORK_QUEUE_SIZE];
-static volatile unsigned work_queue_next = 0;
+static unsigned work_queue_next = 0;
+static unsigned work_queue_tail = 0;
 static volatile unsigned work_queue_fill = 0;
 
 static pthread_mutex_t work_queue_mutex = PTHREAD_MUTEX_INITIALIZER;
@@ -98,6 +115,15 @@ static pthread_cond_t  work_queue_is_empty_sig = PTHREAD_COND_INITIALIZER;
 static pthread_cond_t  work_queue_notempty_sig = PTHREAD_COND_INITIALIZER;
 static pthread_cond_t  work_queue_minfree_sig = PTHREAD_COND_INITIALIZER;
 
+static inline void work_queue_signal(pthread_cond_t*sig)
+{
+	// The waiting thread tests its condition with the mutex held,
+	// so taking the mutex here makes sure that the signal is not
+	// sent between the test and the wait.
+      pthread_mutex_lock(&work_queue_mutex);
+      pthread_cond_signal(sig);
+      pthread_mutex_unlock(&work_queue_mutex);
+}
 
 extern "C" struct vcd_work_item_s* vcd_work_thread_peek(void)
 {
@@ -113,47 +139,48 @@ extern "C" struct vcd_work_item_s* vcd_work_thread_peek(void)
 	    pthread_mutex_unlock(&work_queue_mutex);
       }
 
+	// Do not let the reads of the work item pass the read of the
+	// fill count.
+      __sync_synchronize();
+
       return work_queue + work_queue_next;
 }
 
 extern "C" void vcd_work_thread_pop(void)
 {
-      pthread_mutex_lock(&work_queue_mutex);
-
-      unsigned use_fill = work_queue_fill - 1;
-      work_queue_fill = use_fill;
-
       unsigned use_next = work_queue_next;
 
       struct vcd_work_item_s*cell = work_queue + use_next;
-      if (cell->type == WT_EMIT_BITS) {
+      if (cell->type == WT_EMIT_BITS && cell->op_.val_char != cell->inline_.bits) {
 	    free(cell->op_.val_char);
       }
+      if (cell->type == WT_EMIT_VECTOR && cell->op_.val_words != cell->inline_.words) {
+	    free(cell->op_.val_words);
+      }
 
       use_next += 1;
       if (use_next >= WORK_QUEUE_SIZE)
 	    use_next = 0;
       work_queue_next = use_next;
 
+      unsigned use_fill = __sync_sub_and_fetch(&work_queue_fill, 1);
+
       if (use_fill == WORK_QUEUE_SIZE-WORK_QUEUE_BATCH_MIN)
-	    pthread_cond_signal(&work_queue_minfree_sig);
+	    work_queue_signal(&work_queue_minfree_sig);
       else if (use_fill == 0)
-	    pthread_cond_signal(&work_queue_is_empty_sig);
-
-      pthread_mutex_unlock(&work_queue_mutex);
+	    work_queue_signal(&work_queue_is_empty_sig);
 }
 
 /*
  * Work queue items are created in batches to reduce thread
  * bouncing. When the producer gets a free work item, it actually
- * locks the queue in order to produce a batch. The queue stays locked
- * until the batch is complete. Then the releases the whole lot to the
- * consumer.
+ * reserves a batch of free items. It fills the batch without telling
+ * the consumer, then releases the whole lot to the consumer with a
+ * single update of the fill count.
  */
 static uint64_t work_queue_next_time = 0;
 static unsigned current_batch_cnt = 0;
 static unsigned current_batch_alloc = 0;
-static unsigned current_batch_base = 0;
 
 extern "C" void vcd_work_start( void* (*fun) (void*), void*arg )
 {
@@ -163,25 +190,22 @@ extern "C" void vcd_work_start( void* (*fun) (void*), void*arg )
 static struct vcd_work_item_s* grab_item(void)
 {
       if (current_batch_alloc == 0) {
-	     pthread_mutex_lock(&work_queue_mutex);
-	     while ((WORK_QUEUE_SIZE-work_queue_fill) < WORK_QUEUE_BATCH_MIN)
-		  pthread_cond_wait(&work_queue_minfree_sig, &work_queue_mutex);
-
-	     current_batch_base = work_queue_next + work_queue_fill;
-	     current_batch_alloc = WORK_QUEUE_SIZE - work_queue_fill;
-
-	     pthread_mutex_unlock(&work_queue_mutex);
-
-	     if (current_batch_base >= WORK_QUEUE_SIZE)
-		   current_batch_base -= WORK_QUEUE_SIZE;
-	     if (current_batch_alloc > WORK_QUEUE_BATCH_MAX)
-		   current_batch_alloc = WORK_QUEUE_BATCH_MAX;
-	     current_batch_cnt = 0;
+	    if ((WORK_QUEUE_SIZE-work_queue_fill) < WORK_QUEUE_BATCH_MIN) {
+		  pthread_mutex_lock(&work_queue_mutex);
+		  while ((WORK_QUEUE_SIZE-work_queue_fill) < WORK_QUEUE_BATCH_MIN)
+			pthread_cond_wait(&work_queue_minfree_sig, &work_queue_mutex);
+		  pthread_mutex_unlock(&work_queue_mutex);
+	    }
+
+	    current_batch_alloc = WORK_QUEUE_SIZE - work_queue_fill;
+	    if (current_batch_alloc > WORK_QUEUE_BATCH_MAX)
+		  current_batch_alloc = WORK_QUEUE_BATCH_MAX;
+	    current_batch_cnt = 0;
       }
 
       assert(current_batch_cnt < current_batch_alloc);
 
-      unsigned cur = current_batch_base + current_batch_cnt;
+      unsigned cur = work_queue_tail + current_batch_cnt;
       if (cur >= WORK_QUEUE_SIZE)
 	    cur -= WORK_QUEUE_SIZE;
 
@@ -193,21 +217,21 @@ static struct vcd_work_item_s* grab_item(void)
 
 static void end_batch(void)
 {
-      pthread_mutex_lock(&work_queue_mutex);
-
-      unsigned use_fill = work_queue_fill;
-      bool was_empty_flag = (use_fill==0) && (current_batch_cnt > 0);
+      unsigned use_cnt = current_batch_cnt;
 
-      use_fill += current_batch_cnt;
-      work_queue_fill = use_fill;
+      work_queue_tail += use_cnt;
+      if (work_queue_tail >= WORK_QUEUE_SIZE)
+	    work_queue_tail -= WORK_QUEUE_SIZE;
 
       current_batch_alloc = 0;
       current_batch_cnt = 0;
 
-      if (was_empty_flag)
-	    pthread_cond_signal(&work_queue_notempty_sig);
+      if (use_cnt == 0)
+	    return;
 
-      pthread_mutex_unlock(&work_queue_mutex);
+      unsigned was_fill = __sync_fetch_and_add(&work_queue_fill, use_cnt);
+      if (was_fill == 0)
+	    work_queue_signal(&work_queue_notempty_sig);
 }
 
 static inline void unlock_item(bool flush_batch =false)
@@ -228,6 +252,10 @@ extern "C" void vcd_work_sync(void)
 		  pthread_cond_wait(&work_queue_is_empty_sig, &work_queue_mutex);
 	    pthread_mutex_unlock(&work_queue_mutex);
       }
+
+	// Make everything the work thread did visible to the caller,
+	// who may now take over the output file.
+      __sync_synchronize();
 }
 
 extern "C" void vcd_work_flush(void)
@@ -265,14 +293,64 @@ extern "C" void vcd_work_emit_double(struct lxt2_wr_symbol*sym, double val)
       unlock_item();
 }
 
+static inline void set_item_bits(struct vcd_work_item_s*cell, const char*val)
+{
+      size_t len = strlen(val);
+      if (len < sizeof cell->inline_.bits) {
+	    memcpy(cell->inline_.bits, val, len+1);
+	    cell->op_.val_char = cell->inline_.bits;
+      } else {
+	    cell->op_.val_char = strdup(val);
+      }
+}
+
 extern "C" void vcd_work_emit_bits(struct lxt2_wr_symbol*sym, const char* val)
 {
 
       struct vcd_work_item_s*cell = grab_item();
       cell->type = WT_EMIT_BITS;
       cell->sym_.lxt2 = sym;
-      cell->op_.val_char = strdup(val);
+      set_item_bits(cell, val);
+
+      unlock_item();
+}
 
+extern "C" void vcd_work_emit_ident_double(const char*ident, double val)
+{
+      struct vcd_work_item_s*cell = grab_item();
+      cell->type = WT_EMIT_DOUBLE;
+      cell->sym_.ident = ident;
+      cell->op_.val_double = val;
+      unlock_item();
+}
+
+extern "C" void vcd_work_emit_ident_bits(const char*ident, const char*val)
+{
+      struct vcd_work_item_s*cell = grab_item();
+      cell->type = WT_EMIT_BITS;
+      cell->sym_.ident = ident;
+      set_item_bits(cell, val);
+      unlock_item();
+}
+
+extern "C" void vcd_work_emit_ident_raw(const char*ident, const s_vpi_rawval*val)
+{
+      unsigned nwords = (val->width + 8*sizeof(unsigned long) - 1)
+                        / (8*sizeof(unsigned long));
+
+      struct vcd_work_item_s*cell = grab_item();
+      cell->type = WT_EMIT_VECTOR;
+      cell->wid = val->width;
+      cell->sym_.ident = ident;
+      if (2*nwords <= sizeof cell->inline_.words / sizeof(unsigned long)) {
+	    cell->op_.val_words = cell->inline_.words;
+      } else {
+	    cell->op_.val_words = (unsigned long*)
+		  malloc(2*nwords*sizeof(unsigned long));
+      }
+      memcpy(cell->op_.val_words, val->aval, nwords*sizeof(unsigned long));
+      memcpy(cell->op_.val_words+nwords, val->bval,
+             nwords*sizeof(unsigned long));
       unlock_item();
 }
 
@@ -110,6 +110,21 @@ typedef struct t_vpi_strengthval {
       PLI_INT32 s0, s1;
 } s_vpi_strengthval, *p_vpi_strengthval;
 
+/*
+ * This is an Icarus Verilog extension. Getting a value with the
+ * _vpiRawFourStateVal format sets value.misc to point at one of
+ * these. The aval and bval arrays hold the bits of the value, least
+ * significant first, 8*sizeof(unsigned long) bits per word, with the
+ * same ab encoding as s_vpi_vecval. Bits past the width in the last
+ * word are undefined. Where it can, the simulator points these at
+ * the bits of the signal itself, so they are only good until the
+ * simulation continues, and must not be written.
+ */
+typedef struct t_vpi_rawval {
+      PLI_UINT32 width;
+      const unsigned long *aval, *bval;
+} s_vpi_rawval, *p_vpi_rawval;
+
 /*
  * This structure holds values that are passed back and forth between
  * the simulator and the application.
@@ -250,6 +265,8 @@ typedef struct t_vpi_delay  {
 #define vpiTimeVal     11
 #define vpiObjTypeVal  12
 #define vpiSuppressVal 13
+/* IVL private value format, see s_vpi_rawval */
+#define _vpiRawFourStateVal 0x1000000
 
 
 /* SCALAR VALUES */
@@ -209,6 +209,7 @@ void __vpiArray::get_word_value(struct __vpiArrayWord*word, p_vpi_value vp)
             case vpiHexStrVal:
             case vpiScalarVal:
             case vpiIntVal:
+            case _vpiRawFourStateVal:
             {
                 vvp_vector4_t v;
                 vals->get_word(index, v);
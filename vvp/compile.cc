@@ -823,6 +823,10 @@ void compile_cleanup(void)
       }
 
       vpi_mode_flag = VPI_MODE_NONE;
+
+	/* The netlist is now complete, so make the compact copy of
+	   the fan-out lists. */
+      vvp_net_compact_fanout();
 }
 
 void compile_vpi_symbol(const char*label, vpiHandle obj)
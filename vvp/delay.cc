@@ -20,6 +20,7 @@
 #include "delay.h"
 #include "schedule.h"
 #include "vpi_priv.h"
+#include "slab.h"
 #include "config.h"
 #ifdef CHECK_WITH_VALGRIND
 #include "vvp_cleanup.h"
@@ -148,6 +149,24 @@ void vvp_delay_t::set_decay(vvp_time64_t val)
 	    calculate_min_delay_();
 }
 
+/*
+ * Delay events are created and destroyed for every transition that
+ * passes through a delay, so allocate them from a slab.
+ */
+static const size_t DELAY_EVENT_CHUNK_COUNT = 65536 / sizeof(vvp_fun_delay::event_);
+static slab_t<sizeof(vvp_fun_delay::event_),DELAY_EVENT_CHUNK_COUNT> delay_event_heap;
+
+inline void* vvp_fun_delay::event_::operator new(size_t size)
+{
+      assert(size == sizeof(vvp_fun_delay::event_));
+      return delay_event_heap.alloc_slab();
+}
+
+void vvp_fun_delay::event_::operator delete(void*ptr)
+{
+      delay_event_heap.free_slab(ptr);
+}
+
 vvp_fun_delay::vvp_fun_delay(vvp_net_t*n, unsigned width, const vvp_delay_t&d)
 : net_(n), delay_(d)
 {
@@ -325,10 +344,8 @@ void vvp_fun_delay::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
 	    net_->send_vec4(cur_vec4_, 0);
       } else {
 	    struct event_*cur = new struct event_(use_simtime);
-	    cur->run_run_ptr = &vvp_fun_delay::run_run_vec4_;
 	    cur->ptr_vec4 = bit;
-	    enqueue_(cur);
-	    schedule_generic(this, use_delay, false);
+	    schedule_event_(cur, use_delay);
       }
 }
 
@@ -398,9 +415,7 @@ void vvp_fun_delay::recv_vec8(vvp_net_ptr_t port, const vvp_vector8_t&bit)
       } else {
 	    struct event_*cur = new struct event_(use_simtime);
 	    cur->ptr_vec8 = bit;
-	    cur->run_run_ptr = &vvp_fun_delay::run_run_vec8_;
-	    enqueue_(cur);
-	    schedule_generic(this, use_delay, false);
+	    schedule_event_(cur, use_delay);
       }
 }
 
@@ -465,45 +480,51 @@ void vvp_fun_delay::recv_real(vvp_net_ptr_t port, double bit,
 	    net_->send_real(cur_real_, 0);
       } else {
 	    struct event_*cur = new struct event_(use_simtime);
-	    cur->run_run_ptr = &vvp_fun_delay::run_run_real_;
 	    cur->ptr_real = bit;
-	    enqueue_(cur);
-
-	    schedule_generic(this, use_delay, false);
+	    schedule_event_(cur, use_delay);
       }
 }
 
-void vvp_fun_delay::run_run()
+void vvp_fun_delay::schedule_event_(struct event_*cur, vvp_time64_t use_delay)
 {
-      vvp_time64_t sim_time = schedule_simtime();
-      if (list_ == 0 || list_->next->sim_time > sim_time)
-	    return;
-
-      struct event_*cur = dequeue_();
-      if (cur == 0)
-	    return;
+	/* The scheduler entry of the last queued event runs all the
+	   events that are due at that time, so an event for the same
+	   time does not need its own. */
+      bool share = list_ && list_->sim_time == cur->sim_time;
 
-      (this->*(cur->run_run_ptr))(cur);
-      initial_ = false;
-      delete cur;
+      enqueue_(cur);
+      if (! share)
+	    schedule_generic(this, use_delay, false);
 }
 
-void vvp_fun_delay::run_run_vec4_(struct event_*cur)
+void vvp_fun_delay::run_run()
 {
-      cur_vec4_ = cur->ptr_vec4;
-      net_->send_vec4(cur_vec4_, 0);
-}
+      vvp_time64_t sim_time = schedule_simtime();
 
-void vvp_fun_delay::run_run_vec8_(struct vvp_fun_delay::event_*cur)
-{
-      cur_vec8_ = cur->ptr_vec8;
-      net_->send_vec8(cur_vec8_);
-}
+      while (list_ && list_->next->sim_time <= sim_time) {
+	    struct event_*cur = dequeue_();
 
-void vvp_fun_delay::run_run_real_(struct vvp_fun_delay::event_*cur)
-{
-      cur_real_ = cur->ptr_real;
-      net_->send_real(cur_real_, 0);
+	    switch (type_) {
+		case VEC4_DELAY:
+		  cur_vec4_ = cur->ptr_vec4;
+		  net_->send_vec4(cur_vec4_, 0);
+		  break;
+		case VEC8_DELAY:
+		  cur_vec8_ = cur->ptr_vec8;
+		  net_->send_vec8(cur_vec8_);
+		  break;
+		case REAL_DELAY:
+		  cur_real_ = cur->ptr_real;
+		  net_->send_real(cur_real_, 0);
+		  break;
+		default:
+		  assert(0);
+		  break;
+	    }
+
+	    initial_ = false;
+	    delete cur;
+      }
 }
 
 vvp_fun_modpath::vvp_fun_modpath(vvp_net_t*net, unsigned width)
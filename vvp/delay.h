@@ -75,17 +75,25 @@ class vvp_delay_t {
 class vvp_fun_delay  : public vvp_net_fun_t, private vvp_gen_event_s {
 
       enum delay_type_t {UNKNOWN_DELAY, VEC4_DELAY, VEC8_DELAY, REAL_DELAY};
+
+    public:
+	// The type_ of the functor selects which of the values in the
+	// event is used. The unused vectors are empty, and so do not
+	// allocate any storage. This is public so that the slab that
+	// holds the events can be sized.
       struct event_ {
 	    explicit event_(vvp_time64_t s) : sim_time(s) {
 		  ptr_real = 0.0;
 		  next = NULL;
 	    }
-	    void (vvp_fun_delay::*run_run_ptr)(struct vvp_fun_delay::event_*cur);
 	    const vvp_time64_t sim_time;
 	    vvp_vector4_t ptr_vec4;
 	    vvp_vector8_t ptr_vec8;
 	    double ptr_real;
 	    struct event_*next;
+
+	    static void* operator new(size_t);
+	    static void operator delete(void*);
       };
 
     public:
@@ -108,10 +116,9 @@ class vvp_fun_delay  : public vvp_net_fun_t, private vvp_gen_event_s {
     private:
       virtual void run_run();
 
-
-      void run_run_vec4_(struct vvp_fun_delay::event_*cur);
-      void run_run_vec8_(struct vvp_fun_delay::event_*cur);
-      void run_run_real_(struct vvp_fun_delay::event_*cur);
+	// Queue the event, and schedule it unless it can share the
+	// scheduler entry of an event already queued for that time.
+      void schedule_event_(struct event_*cur, vvp_time64_t use_delay);
 
     private:
       vvp_net_t*net_;
@@ -74,6 +74,21 @@ void vvp_fun_boolean_::recv_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
       }
 }
 
+/*
+ * The inputs are normally all the same width, so that the gates can
+ * work on the whole vectors a word at a time. Otherwise they fall
+ * back to working bit by bit.
+ */
+bool vvp_fun_boolean_::inputs_match_() const
+{
+      unsigned wid = input_[0].size();
+      for (unsigned pdx = 1 ;  pdx < 4 ;  pdx += 1) {
+	    if (input_[pdx].size() != wid)
+		  return false;
+      }
+      return true;
+}
+
 vvp_fun_and::vvp_fun_and(unsigned wid, bool invert)
 : vvp_fun_boolean_(wid), invert_(invert)
 {
@@ -91,6 +106,15 @@ void vvp_fun_and::run_run()
 
       vvp_vector4_t result (input_[0]);
 
+      if (inputs_match_()) {
+	    for (unsigned pdx = 1 ;  pdx < 4 ;  pdx += 1)
+		  result &= input_[pdx];
+	    if (invert_)
+		  result.invert();
+	    ptr->send_vec4(result, 0);
+	    return;
+      }
+
       for (unsigned idx = 0 ;  idx < result.size() ;  idx += 1) {
 	    vvp_bit4_t bitbit = result.value(idx);
 	    for (unsigned pdx = 1 ;  pdx < 4 ;  pdx += 1) {
@@ -411,28 +435,32 @@ void vvp_fun_muxz::run_run()
 	    ptr->send_vec4(b_, 0);
 	    break;
 	  default:
-	      {
-		    unsigned min_size = a_.size();
-		    unsigned max_size = a_.size();
-		    if (b_.size() < min_size)
-			  min_size = b_.size();
-		    if (b_.size() > max_size)
-			  max_size = b_.size();
-
-		    vvp_vector4_t res (max_size);
-
-		    for (unsigned idx = 0 ;  idx < min_size ;  idx += 1) {
-			  if (a_.value(idx) == b_.value(idx))
-				res.set_bit(idx, a_.value(idx));
-			  else
-				res.set_bit(idx, BIT4_X);
-		    }
-
-		    for (unsigned idx = min_size ;  idx < max_size ;  idx += 1)
-			  res.set_bit(idx, BIT4_X);
-
-		    ptr->send_vec4(res, 0);
-	      }
+	    if (a_.size() == b_.size()) {
+		  vvp_vector4_t res (a_);
+		  res.blend(b_);
+		  ptr->send_vec4(res, 0);
+	    } else {
+		  unsigned min_size = a_.size();
+		  unsigned max_size = a_.size();
+		  if (b_.size() < min_size)
+			min_size = b_.size();
+		  if (b_.size() > max_size)
+			max_size = b_.size();
+
+		  vvp_vector4_t res (max_size);
+
+		  for (unsigned idx = 0 ;  idx < min_size ;  idx += 1) {
+			if (a_.value(idx) == b_.value(idx))
+			      res.set_bit(idx, a_.value(idx));
+			else
+			      res.set_bit(idx, BIT4_X);
+		  }
+
+		  for (unsigned idx = min_size ;  idx < max_size ;  idx += 1)
+			res.set_bit(idx, BIT4_X);
+
+		  ptr->send_vec4(res, 0);
+	    }
 	    break;
       }
 }
@@ -515,6 +543,15 @@ void vvp_fun_or::run_run()
 
       vvp_vector4_t result (input_[0]);
 
+      if (inputs_match_()) {
+	    for (unsigned pdx = 1 ;  pdx < 4 ;  pdx += 1)
+		  result |= input_[pdx];
+	    if (invert_)
+		  result.invert();
+	    ptr->send_vec4(result, 0);
+	    return;
+      }
+
       for (unsigned idx = 0 ;  idx < result.size() ;  idx += 1) {
 	    vvp_bit4_t bitbit = result.value(idx);
 	    for (unsigned pdx = 1 ;  pdx < 4 ;  pdx += 1) {
@@ -551,6 +588,15 @@ void vvp_fun_xor::run_run()
 
       vvp_vector4_t result (input_[0]);
 
+      if (inputs_match_()) {
+	    for (unsigned pdx = 1 ;  pdx < 4 ;  pdx += 1)
+		  result ^= input_[pdx];
+	    if (invert_)
+		  result.invert();
+	    ptr->send_vec4(result, 0);
+	    return;
+      }
+
       for (unsigned idx = 0 ;  idx < result.size() ;  idx += 1) {
 	    vvp_bit4_t bitbit = result.value(idx);
 	    for (unsigned pdx = 1 ;  pdx < 4 ;  pdx += 1) {
@@ -39,6 +39,8 @@ class vvp_fun_boolean_ : public vvp_net_fun_t, protected vvp_gen_event_s {
                         vvp_context_t);
 
     protected:
+      bool inputs_match_() const;
+
       vvp_vector4_t input_[4];
       vvp_net_t*net_;
 };
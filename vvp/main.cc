@@ -27,6 +27,7 @@
 # include  "statistics.h"
 # include  "vvp_cleanup.h"
 # include  "vvp_object.h"
+# include  "profile.h"
 # include  <cstdio>
 # include  <cstdlib>
 # include  <cstring>
@@ -480,6 +481,8 @@ int main(int argc, char*argv[])
 	    vpi_mcd_printf(1, " ... %8lu nets\n",     count_vpi_nets);
 	    vpi_mcd_printf(1, " ... %8lu vvp_nets (%zu bytes)\n",
 			   count_vvp_nets, size_vvp_nets);
+	    vpi_mcd_printf(1, "           %8lu compact fan-out (%zu bytes)\n",
+			   count_fanout_nets, size_fanout_table);
 	    vpi_mcd_printf(1, " ... %8lu arrays (%lu words)\n",
 			   count_net_arrays, count_net_array_words);
 	    vpi_mcd_printf(1, " ... %8lu memories\n",
@@ -489,6 +492,9 @@ int main(int argc, char*argv[])
 	    vpi_mcd_printf(1, "           %8lu real (%lu words)\n",
 			   count_real_arrays, count_real_array_words);
 	    vpi_mcd_printf(1, " ... %8lu scopes\n",   count_vpi_scopes);
+	    vpi_mcd_printf(1, " ... %8lu symbols (%lu lookups, %lu probes)\n",
+			   count_symbols, count_symbol_lookups,
+			   count_symbol_probes);
       }
 
       if (verbose_flag) {
@@ -498,8 +504,22 @@ int main(int argc, char*argv[])
       }
 
 
+	/* The +vvp-profile[=<path>] plusarg turns on the sampling
+	   profiler for the duration of the simulation. */
+      const char*profile_path = 0;
+      for (int idx = optind+1 ;  idx < argc ;  idx += 1) {
+	    if (strcmp(argv[idx], "+vvp-profile") == 0)
+		  profile_path = "vvp.prof";
+	    else if (strncmp(argv[idx], "+vvp-profile=", 13) == 0)
+		  profile_path = argv[idx]+13;
+      }
+      if (profile_path)
+	    vvp_profile_start(profile_path);
+
       schedule_simulate();
 
+      vvp_profile_finish();
+
       if (verbose_flag) {
 	    my_getrusage(cycles+2);
 	    print_rusage(cycles+2, cycles+1);
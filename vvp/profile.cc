@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "config.h"
+# include  "profile.h"
+# include  "vpi_priv.h"
+# include  <algorithm>
+# include  <csignal>
+# include  <cstdio>
+# include  <cstdlib>
+# include  <cstring>
+# include  <string>
+# include  <vector>
+#ifdef HAVE_SETITIMER
+# include  <sys/time.h>
+#endif
+#if defined(__GNUC__)
+# include  <cxxabi.h>
+#endif
+
+bool vvp_profile_flag = false;
+__vpiScope*volatile vvp_profile_scope = 0;
+const std::type_info*volatile vvp_profile_type = 0;
+
+/*
+ * The samples are counted in a fixed size open addressing hash table
+ * keyed by the (scope, type) pair. The signal handler cannot allocate
+ * memory, so the table is allocated up front, and samples that do not
+ * fit once the table is full are counted as lost.
+ */
+struct profile_cell_s {
+      __vpiScope*scope;
+      const std::type_info*type;
+      unsigned long count;
+};
+
+static const unsigned PROFILE_TABLE_SIZE = 64*1024;
+static const long PROFILE_PERIOD_USEC = 1000;
+
+static struct profile_cell_s*profile_table = 0;
+static unsigned long profile_samples = 0;
+static unsigned long profile_lost = 0;
+static const char*profile_path = 0;
+
+#ifdef HAVE_SETITIMER
+static unsigned profile_table_used = 0;
+
+extern "C" void profile_handler(int)
+{
+      __vpiScope*scope = vvp_profile_scope;
+      const std::type_info*type = scope? 0 : vvp_profile_type;
+
+      profile_samples += 1;
+
+      size_t hash = ((size_t)scope >> 4) ^ ((size_t)type >> 4);
+      unsigned idx = hash % PROFILE_TABLE_SIZE;
+      for (;;) {
+	    struct profile_cell_s*cur = profile_table + idx;
+	    if (cur->count == 0) {
+		    /* Leave some space so the probe sequences
+		       always end at an empty cell. */
+		  if (profile_table_used >= PROFILE_TABLE_SIZE/2) {
+			profile_lost += 1;
+			return;
+		  }
+		  cur->scope = scope;
+		  cur->type = type;
+		  cur->count = 1;
+		  profile_table_used += 1;
+		  return;
+	    }
+	    if (cur->scope == scope && cur->type == type) {
+		  cur->count += 1;
+		  return;
+	    }
+	    idx = (idx + 1) % PROFILE_TABLE_SIZE;
+      }
+}
+#endif
+
+void vvp_profile_start(const char*path)
+{
+      profile_path = path;
+#ifdef HAVE_SETITIMER
+      profile_table = new struct profile_cell_s[PROFILE_TABLE_SIZE];
+      memset(profile_table, 0, PROFILE_TABLE_SIZE*sizeof(profile_cell_s));
+
+      signal(SIGPROF, &profile_handler);
+
+      struct itimerval period;
+      period.it_interval.tv_sec = 0;
+      period.it_interval.tv_usec = PROFILE_PERIOD_USEC;
+      period.it_value = period.it_interval;
+      setitimer(ITIMER_PROF, &period, 0);
+
+      vvp_profile_flag = true;
+#else
+      vpi_mcd_printf(1, "Warning: +vvp-profile is not supported on "
+		     "this platform.\n");
+#endif
+}
+
+static void profile_scope_name(std::string&res, __vpiScope*scope)
+{
+      if (scope->scope) {
+	    profile_scope_name(res, scope->scope);
+	    res += ";";
+      }
+      res += scope->scope_name();
+}
+
+static std::string profile_type_name(const std::type_info*type)
+{
+      const char*name = type->name();
+#if defined(__GNUC__)
+      int status = 0;
+      char*tmp = abi::__cxa_demangle(name, 0, 0, &status);
+      if (tmp && status == 0) {
+	    std::string res = tmp;
+	    free(tmp);
+	    return res;
+      }
+      free(tmp);
+#endif
+      return name;
+}
+
+static bool profile_entry_compare(const std::pair<std::string,unsigned long>&a,
+				  const std::pair<std::string,unsigned long>&b)
+{
+      return a.second > b.second;
+}
+
+/*
+ * Stop the timer and write the report. Each line of the report has
+ * the form "frame;frame;... count", which is the "folded" format that
+ * flame graph tools take as input. Scopes are written as their path
+ * in the hierarchy, and types under a "<scheduler>" root.
+ */
+void vvp_profile_finish(void)
+{
+      if (! vvp_profile_flag)
+	    return;
+
+#ifdef HAVE_SETITIMER
+      struct itimerval period;
+      memset(&period, 0, sizeof period);
+      setitimer(ITIMER_PROF, &period, 0);
+      signal(SIGPROF, SIG_DFL);
+#endif
+      vvp_profile_flag = false;
+
+      std::vector< std::pair<std::string,unsigned long> > entries;
+      for (unsigned idx = 0 ; idx < PROFILE_TABLE_SIZE ; idx += 1) {
+	    struct profile_cell_s*cur = profile_table + idx;
+	    if (cur->count == 0)
+		  continue;
+
+	    std::string name;
+	    if (cur->scope) {
+		  profile_scope_name(name, cur->scope);
+	    } else if (cur->type) {
+		  name = "<scheduler>;" + profile_type_name(cur->type);
+	    } else {
+		  name = "<idle>";
+	    }
+	    entries.push_back(std::make_pair(name, cur->count));
+      }
+
+      std::sort(entries.begin(), entries.end(), profile_entry_compare);
+
+      FILE*fd = fopen(profile_path, "w");
+      if (fd == 0) {
+	    perror(profile_path);
+      } else {
+	    for (size_t idx = 0 ; idx < entries.size() ; idx += 1)
+		  fprintf(fd, "%s %lu\n", entries[idx].first.c_str(),
+			  entries[idx].second);
+	    fclose(fd);
+
+	    vpi_mcd_printf(1, "Profile: %lu samples (%lu lost) written "
+			   "to %s\n", profile_samples, profile_lost,
+			   profile_path);
+      }
+
+      delete[]profile_table;
+      profile_table = 0;
+}
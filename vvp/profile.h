@@ -0,0 +1,50 @@
+#ifndef IVL_profile_H
+#define IVL_profile_H
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  <typeinfo>
+
+class __vpiScope;
+
+/*
+ * The profiler is enabled by the +vvp-profile plusarg. While it is
+ * running, a CPU time interval timer periodically samples what the
+ * simulator is doing. The vthread_run function sets vvp_profile_scope
+ * to the scope of the thread it is running, the scheduler sets
+ * vvp_profile_type to the type of the event that it is running, and
+ * the vvp_net_t send functions set it to the type of each functor that
+ * receives a value. A sample is charged to the scope if there is one,
+ * or to the type otherwise.
+ *
+ * The scheduler and the send functions only keep vvp_profile_type up
+ * to date if the vvp_profile_flag is set.
+ */
+extern bool vvp_profile_flag;
+extern __vpiScope*volatile vvp_profile_scope;
+extern const std::type_info*volatile vvp_profile_type;
+
+/*
+ * Start the sampling timer. The report is written to the given path
+ * when vvp_profile_finish() is called.
+ */
+extern void vvp_profile_start(const char*path);
+extern void vvp_profile_finish(void);
+
+#endif /* IVL_profile_H */
@@ -24,8 +24,10 @@
 # include  "vvp_net_sig.h"
 # include  "slab.h"
 # include  "compile.h"
+# include  "profile.h"
 # include  <new>
 # include  <typeinfo>
+# include  <map>
 # include  <csignal>
 # include  <cstdlib>
 # include  <cassert>
@@ -61,6 +63,10 @@ struct event_s {
 	// Write something about the event to stderr
       virtual void single_step_display(void);
 
+	// The type that profile samples taken while running this
+	// event are charged to.
+      virtual const std::type_info& profile_type(void);
+
 	// Fallback new/delete
       static void*operator new (size_t size) { return ::new char[size]; }
       static void operator delete(void*ptr)  { ::delete[]( (char*)ptr ); }
@@ -71,6 +77,11 @@ void event_s::single_step_display(void)
       std::cerr << "event_s: Step into event " << typeid(*this).name() << std::endl;
 }
 
+const std::type_info& event_s::profile_type(void)
+{
+      return typeid(*this);
+}
+
 struct event_time_s {
       event_time_s() {
 	    count_time_events += 1;
@@ -81,9 +92,9 @@ struct event_time_s {
 	    rwsync = 0;
 	    rosync = 0;
 	    del_thr = 0;
-	    next = NULL;
       }
-      vvp_time64_t delay;
+	// Absolute simulation time of this time step.
+      vvp_time64_t time;
 
       struct event_s*start;
       struct event_s*active;
@@ -93,8 +104,6 @@ struct event_time_s {
       struct event_s*rosync;
       struct event_s*del_thr;
 
-      struct event_time_s*next;
-
       static void* operator new (size_t);
       static void operator delete(void*obj, size_t s);
 };
@@ -166,6 +175,20 @@ void del_thr_event_s::single_step_display(void)
 	   << " scope=" << scope->vpi_get_str(vpiFullName) << endl;
 }
 
+/*
+ * Profile samples taken while an event delivers a value are charged to
+ * the type of the functor that receives it. The vvp_net_t send
+ * functions move the charge along to each functor that the value
+ * propagates through after that.
+ */
+static const std::type_info& net_profile_type(event_s*ev, vvp_net_ptr_t ptr)
+{
+      vvp_net_t*net = ptr.ptr();
+      if (net && net->fun)
+	    return typeid(*net->fun);
+      return typeid(*ev);
+}
+
 struct assign_vector4_event_s  : public event_s {
 	/* The default constructor. */
       explicit assign_vector4_event_s(const vvp_vector4_t&that) : val(that) {
@@ -183,6 +206,7 @@ struct assign_vector4_event_s  : public event_s {
       unsigned vwid;
       void run_run(void);
       void single_step_display(void);
+      const std::type_info& profile_type(void);
 
       static void* operator new(size_t);
       static void operator delete(void*);
@@ -203,6 +227,11 @@ void assign_vector4_event_s::single_step_display(void)
 	   << ", vwid=" << vwid << ", base=" << base << endl;
 }
 
+const std::type_info& assign_vector4_event_s::profile_type(void)
+{
+      return net_profile_type(this, ptr);
+}
+
 static const size_t ASSIGN4_CHUNK_COUNT = 524288 / sizeof(struct assign_vector4_event_s);
 static slab_t<sizeof(assign_vector4_event_s),ASSIGN4_CHUNK_COUNT> assign4_heap;
 
@@ -224,6 +253,7 @@ struct assign_vector8_event_s  : public event_s {
       vvp_vector8_t val;
       void run_run(void);
       void single_step_display(void);
+      const std::type_info& profile_type(void);
 
       static void* operator new(size_t);
       static void operator delete(void*);
@@ -240,6 +270,11 @@ void assign_vector8_event_s::single_step_display(void)
       cerr << "assign_vector8_event: Propagate val=" << val << endl;
 }
 
+const std::type_info& assign_vector8_event_s::profile_type(void)
+{
+      return net_profile_type(this, ptr);
+}
+
 static const size_t ASSIGN8_CHUNK_COUNT = 8192 / sizeof(struct assign_vector8_event_s);
 static slab_t<sizeof(assign_vector8_event_s),ASSIGN8_CHUNK_COUNT> assign8_heap;
 
@@ -261,6 +296,7 @@ struct assign_real_event_s  : public event_s {
       double val;
       void run_run(void);
       void single_step_display(void);
+      const std::type_info& profile_type(void);
 
       static void* operator new(size_t);
       static void operator delete(void*);
@@ -277,6 +313,11 @@ void assign_real_event_s::single_step_display(void)
       cerr << "assign_real_event: Propagate val=" << val << endl;
 }
 
+const std::type_info& assign_real_event_s::profile_type(void)
+{
+      return net_profile_type(this, ptr);
+}
+
 static const size_t ASSIGNR_CHUNK_COUNT = 8192 / sizeof(struct assign_real_event_s);
 static slab_t<sizeof(assign_real_event_s),ASSIGNR_CHUNK_COUNT> assignr_heap;
 
@@ -492,6 +533,7 @@ struct generic_event_s : public event_s {
       bool delete_obj_when_done;
       void run_run(void);
       void single_step_display(void);
+      const std::type_info& profile_type(void);
 
       static void* operator new(size_t);
       static void operator delete(void*);
@@ -512,6 +554,13 @@ void generic_event_s::single_step_display(void)
       obj->single_step_display();
 }
 
+const std::type_info& generic_event_s::profile_type(void)
+{
+      if (obj)
+	    return typeid(*obj);
+      return typeid(*this);
+}
+
 static const size_t GENERIC_CHUNK_COUNT = 131072 / sizeof(struct generic_event_s);
 static slab_t<sizeof(generic_event_s),GENERIC_CHUNK_COUNT> generic_event_heap;
 
@@ -552,11 +601,132 @@ inline void event_time_s::operator delete(void*ptr, size_t)
 unsigned long count_time_pool(void) { return event_time_heap.pool; }
 
 /*
- * This is the head of the list of pending events. This includes all
- * the events that have not been executed yet, and reaches into the
- * future.
+ * The pending time steps are kept in a timing wheel. The wheel has
+ * SCHED_WHEEL_SIZE slots, and covers the window of times
+ * [sched_wheel_base, sched_wheel_base+SCHED_WHEEL_SIZE). A time step
+ * in that window lives in the slot indexed by the low bits of its
+ * time, so finding the event_time_s for a given time is a single
+ * array index. The sched_wheel_map has a bit set for every occupied
+ * slot so that finding the next pending time step is a scan of a few
+ * words instead of a walk over every slot.
+ *
+ * Time steps that are beyond the window go into the sched_far map,
+ * keyed by time, so there is only ever one event_time_s for a time
+ * and scheduling another event at a far time that already has events
+ * does not allocate anything. As the window advances with the
+ * simulation time, time steps that come into the window are moved
+ * from the map into the wheel.
+ *
+ * The invariant is that every time step in the wheel is before every
+ * time step in the far map.
  */
-static struct event_time_s* sched_list = 0;
+static const unsigned SCHED_WHEEL_BITS = 12;
+static const vvp_time64_t SCHED_WHEEL_SIZE = 1 << SCHED_WHEEL_BITS;
+static const vvp_time64_t SCHED_WHEEL_MASK = SCHED_WHEEL_SIZE - 1;
+static const unsigned SCHED_MAP_WORDS = SCHED_WHEEL_SIZE / 64;
+
+static struct event_time_s* sched_wheel[SCHED_WHEEL_SIZE];
+static uint64_t sched_wheel_map[SCHED_MAP_WORDS];
+static unsigned long sched_wheel_count = 0;
+static vvp_time64_t sched_wheel_base = 0;
+
+typedef std::map<vvp_time64_t,struct event_time_s*> sched_far_t;
+static sched_far_t sched_far;
+
+static inline bool sched_pending_(void)
+{
+      return sched_wheel_count > 0 || !sched_far.empty();
+}
+
+static void sched_wheel_insert_(struct event_time_s*ctim)
+{
+      unsigned slot = ctim->time & SCHED_WHEEL_MASK;
+      assert(sched_wheel[slot] == 0);
+      sched_wheel[slot] = ctim;
+      sched_wheel_map[slot/64] |= (uint64_t)1 << (slot%64);
+      sched_wheel_count += 1;
+}
+
+static void sched_wheel_remove_(struct event_time_s*ctim)
+{
+      unsigned slot = ctim->time & SCHED_WHEEL_MASK;
+      assert(sched_wheel[slot] == ctim);
+      sched_wheel[slot] = 0;
+      sched_wheel_map[slot/64] &= ~((uint64_t)1 << (slot%64));
+      sched_wheel_count -= 1;
+}
+
+/*
+ * Move the window of the wheel forward so that it starts at the given
+ * time, and pull into the wheel all the far time steps that are now
+ * within the window.
+ */
+static void sched_wheel_advance_(vvp_time64_t base)
+{
+      sched_wheel_base = base;
+      while (!sched_far.empty()
+	     && sched_far.begin()->first - base < SCHED_WHEEL_SIZE) {
+	    sched_wheel_insert_(sched_far.begin()->second);
+	    sched_far.erase(sched_far.begin());
+      }
+}
+
+/*
+ * Return the earliest pending time step. The wheel is scanned
+ * circularly from the slot of the window base, and if the wheel is
+ * empty then the window is moved to the earliest far time step.
+ */
+static struct event_time_s* sched_next_(void)
+{
+      if (sched_wheel_count == 0) {
+	    if (sched_far.empty())
+		  return 0;
+	    sched_wheel_advance_(sched_far.begin()->first);
+      }
+
+      unsigned slot = sched_wheel_base & SCHED_WHEEL_MASK;
+      unsigned word = slot / 64;
+      uint64_t bits = sched_wheel_map[word] & (~(uint64_t)0 << (slot%64));
+
+      for (unsigned idx = 0 ; idx <= SCHED_MAP_WORDS ; idx += 1) {
+	    if (bits != 0) {
+		  unsigned hit = word*64 + __builtin_ctzll(bits);
+		  return sched_wheel[hit];
+	    }
+	    word = (word + 1) % SCHED_MAP_WORDS;
+	    bits = sched_wheel_map[word];
+      }
+
+      assert(0);
+      return 0;
+}
+
+/*
+ * Locate (or create) the time step for the given absolute time.
+ */
+static struct event_time_s* sched_time_cell_(vvp_time64_t time)
+{
+      if (time - sched_wheel_base < SCHED_WHEEL_SIZE) {
+	    struct event_time_s*ctim = sched_wheel[time & SCHED_WHEEL_MASK];
+	    if (ctim) {
+		  assert(ctim->time == time);
+		  return ctim;
+	    }
+	    ctim = new struct event_time_s;
+	    ctim->time = time;
+	    sched_wheel_insert_(ctim);
+	    return ctim;
+      }
+
+      sched_far_t::iterator cur = sched_far.lower_bound(time);
+      if (cur != sched_far.end() && cur->first == time)
+	    return cur->second;
+
+      struct event_time_s*ctim = new struct event_time_s;
+      ctim->time = time;
+      sched_far.insert(cur, sched_far_t::value_type(time, ctim));
+      return ctim;
+}
 
 /*
  * This is a list of initialization events. The setup puts
@@ -666,61 +836,13 @@ static void schedule_final_event(struct event_s*cur)
 typedef enum event_queue_e { SEQ_START, SEQ_ACTIVE, SEQ_INACTIVE, SEQ_NBASSIGN,
 			     SEQ_RWSYNC, SEQ_ROSYNC, DEL_THREAD } event_queue_t;
 
+static vvp_time64_t schedule_time;
+
 static void schedule_event_(struct event_s*cur, vvp_time64_t delay,
 			    event_queue_t select_queue)
 {
       cur->next = cur;
-      struct event_time_s*ctim = sched_list;
-
-      if (sched_list == 0) {
-	      /* Is the event_time list completely empty? Create the
-		 first event_time object. */
-	    ctim = new struct event_time_s;
-	    ctim->delay = delay;
-	    ctim->next  = 0;
-	    sched_list = ctim;
-
-      } else if (sched_list->delay > delay) {
-
-	      /* Am I looking for an event before the first event_time?
-		 If so, create a new event_time to go in front. */
-	    struct event_time_s*tmp = new struct event_time_s;
-	    tmp->delay = delay;
-	    tmp->next = ctim;
-	    ctim->delay -= delay;
-	    ctim = tmp;
-	    sched_list = ctim;
-
-      } else {
-	    struct event_time_s*prev = 0;
-
-	    while (ctim->next && (ctim->delay < delay)) {
-		  delay -= ctim->delay;
-		  prev = ctim;
-		  ctim = ctim->next;
-	    }
-
-	    if (ctim->delay > delay) {
-		  struct event_time_s*tmp = new struct event_time_s;
-		  tmp->delay = delay;
-		  tmp->next  = prev->next;
-		  prev->next = tmp;
-
-		  tmp->next->delay -= delay;
-		  ctim = tmp;
-
-	    } else if (ctim->delay == delay) {
-
-	    } else {
-		  assert(ctim->next == 0);
-		  struct event_time_s*tmp = new struct event_time_s;
-		  tmp->delay = delay - ctim->delay;
-		  tmp->next = 0;
-		  ctim->next = tmp;
-
-		  ctim = tmp;
-	    }
-      }
+      struct event_time_s*ctim = sched_time_cell_(schedule_time + delay);
 
 	/* By this point, ctim is the event_time structure that is to
 	   receive the event at hand. Put the event in to the
@@ -771,13 +893,12 @@ static void schedule_event_(struct event_s*cur, vvp_time64_t delay,
 
 static void schedule_event_push_(struct event_s*cur)
 {
-      if ((sched_list == 0) || (sched_list->delay > 0)) {
+      struct event_time_s*ctim = sched_wheel[schedule_time & SCHED_WHEEL_MASK];
+      if ((ctim == 0) || (ctim->time != schedule_time)) {
 	    schedule_event_(cur, 0, SEQ_ACTIVE);
 	    return;
       }
 
-      struct event_time_s*ctim = sched_list;
-
       if (ctim->active == 0) {
 	    cur->next = cur;
 	    ctim->active = cur;
@@ -1016,7 +1137,6 @@ void schedule_at_start_of_simtime(vvp_gen_event_t obj, vvp_time64_t delay)
       schedule_event_(cur, delay, SEQ_START);
 }
 
-static vvp_time64_t schedule_time;
 vvp_time64_t schedule_simtime(void)
 { return schedule_time; }
 
@@ -1122,7 +1242,7 @@ void schedule_simulate(void)
       // process events and when done run the final blocks.
       run_finals = schedule_runnable;
 
-      if (schedule_runnable) while (sched_list) {
+      if (schedule_runnable) while (sched_pending_()) {
 
 	    if (schedule_stopped_flag) {
 		  schedule_stopped_flag = false;
@@ -1133,21 +1253,21 @@ void schedule_simulate(void)
 	    }
 
 	      /* ctim is the current time step. */
-	    struct event_time_s* ctim = sched_list;
+	    struct event_time_s* ctim = sched_next_();
 
 	      /* If the time is advancing, then first run the
 		 postponed sync events. Run them all. */
-	    if (ctim->delay > 0) {
+	    if (ctim->time > schedule_time) {
 
 		  if (!schedule_runnable) break;
-		  schedule_time += ctim->delay;
+		  schedule_time = ctim->time;
+		  sched_wheel_advance_(schedule_time);
 		    /* When the design is being traced (we are emitting
 		     * file/line information) also print any time changes. */
 		  if (show_file_line) {
 			cerr << "Advancing to simulation time: "
 			     << schedule_time << endl;
 		  }
-		  ctim->delay = 0;
 
 		  vpiNextSimTime();
 		    // Process the cbAtStartOfSimTime callbacks.
@@ -1184,7 +1304,7 @@ void schedule_simulate(void)
 				   deletes threads as needed. */
 			      if (ctim->active == 0) {
 				    run_rosync(ctim);
-				    sched_list = ctim->next;
+				    sched_wheel_remove_(ctim);
 				    delete ctim;
 				    continue;
 			      }
@@ -1208,8 +1328,12 @@ void schedule_simulate(void)
 		  schedule_single_step_flag = false;
 	    }
 
+	    if (vvp_profile_flag)
+		  vvp_profile_type = &cur->profile_type();
+
 	    cur->run_run();
 
+	    vvp_profile_type = 0;
 	    delete (cur);
       }
 
@@ -35,5 +35,9 @@ unsigned long count_vpi_nets = 0;
 
 unsigned long count_vpi_scopes = 0;
 
+unsigned long count_symbols = 0;
+unsigned long count_symbol_lookups = 0;
+unsigned long count_symbol_probes = 0;
+
 size_t size_opcodes = 0;
 
@@ -34,9 +34,14 @@ extern unsigned long count_functors_resolv;
 extern unsigned long count_functors_sig;
 extern unsigned long count_filters;
 extern unsigned long count_vvp_nets;
+extern unsigned long count_fanout_nets;
 extern unsigned long count_vpi_nets;
 extern unsigned long count_vpi_scopes;
 
+extern unsigned long count_symbols;
+extern unsigned long count_symbol_lookups;
+extern unsigned long count_symbol_probes;
+
 extern unsigned long count_net_arrays;
 extern unsigned long count_net_array_words;
 extern unsigned long count_var_arrays;
@@ -60,6 +65,7 @@ extern unsigned long count_gen_pool(void);
 
 extern size_t size_opcodes;
 extern size_t size_vvp_nets;
+extern size_t size_fanout_table;
 extern size_t size_vvp_net_funs;
 
 #endif /* IVL_statistics_H */
@@ -70,13 +70,14 @@ class symbol_table_s {
 
     private:
       symbol_table_s(const symbol_table_s&) { assert(0); };
-      struct tree_node_*root;
+      struct hash_cell_*table_;
+      unsigned table_mask_;
+      unsigned count_;
       struct key_strings*str_chunk;
       unsigned str_used;
 
-      symbol_value_t find_value_(struct tree_node_*cur,
-				 const char*key, symbol_value_t val,
-				 bool force_flag);
+      struct hash_cell_*find_cell_(const char*key, unsigned hash);
+      void grow_table_(void);
       char*key_strdup_(const char*str);
 };
 
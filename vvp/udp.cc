@@ -118,6 +118,69 @@ vvp_bit4_t vvp_udp_s::get_init() const
       return init_;
 }
 
+/*
+ * The lookup tables are only built if they have no more than this
+ * many entries.
+ */
+static const unsigned long UDP_TABLE_LIMIT = 65536;
+
+/*
+ * Return the number of values of nbits base 3 digits, or 0 if that is
+ * more than the table limit.
+ */
+static unsigned long udp_table_size(unsigned nbits)
+{
+      unsigned long size = 1;
+      for (unsigned idx = 0 ;  idx < nbits ;  idx += 1) {
+	    size *= 3;
+	    if (size > UDP_TABLE_LIMIT)
+		  return 0;
+      }
+      return size;
+}
+
+/*
+ * Convert the first nbits positions of a levels table to a table
+ * index, and back. Bit 0 is the least significant digit.
+ */
+static unsigned long udp_table_index(const udp_levels_table&cur,
+				     unsigned nbits)
+{
+      unsigned long index = 0;
+      for (unsigned idx = nbits ;  idx > 0 ;  idx -= 1) {
+	    unsigned long mask = 1UL << (idx-1);
+	    index *= 3;
+	    if (cur.mask1 & mask)
+		  index += 1;
+	    else if (cur.maskx & mask)
+		  index += 2;
+      }
+      return index;
+}
+
+static void udp_table_levels(udp_levels_table&cur, unsigned long index,
+			     unsigned nbits)
+{
+      cur.mask0 = 0;
+      cur.mask1 = 0;
+      cur.maskx = 0;
+      for (unsigned idx = 0 ;  idx < nbits ;  idx += 1) {
+	    unsigned long mask = 1UL << idx;
+	    switch (index % 3) {
+		case 0:
+		  cur.mask0 |= mask;
+		  break;
+		case 1:
+		  cur.mask1 |= mask;
+		  break;
+		default:
+		  cur.maskx |= mask;
+		  break;
+	    }
+	    index /= 3;
+      }
+}
+
 vvp_udp_comb_s::vvp_udp_comb_s(char*label, char*name__, unsigned ports)
 : vvp_udp_s(label, name__, ports, BIT4_X, false)
 {
@@ -125,12 +188,14 @@ vvp_udp_comb_s::vvp_udp_comb_s(char*label, char*name__, unsigned ports)
       levels1_ = 0;
       nlevels0_ = 0;
       nlevels1_ = 0;
+      table_ = 0;
 }
 
 vvp_udp_comb_s::~vvp_udp_comb_s()
 {
       delete[] levels0_;
       delete[] levels1_;
+      delete[] table_;
 }
 
 /*
@@ -188,6 +253,9 @@ vvp_bit4_t vvp_udp_comb_s::calculate_output(const udp_levels_table&cur,
 					    const udp_levels_table&,
 					    vvp_bit4_t)
 {
+      if (table_)
+	    return (vvp_bit4_t) table_[udp_table_index(cur, port_count())];
+
       return test_levels(cur);
 }
 
@@ -290,6 +358,19 @@ void vvp_udp_comb_s::compile_table(char**tab)
 
       assert(nrows0 == nlevels0_);
       assert(nrows1 == nlevels1_);
+
+	/* Now evaluate the rows for every input value, if there are
+	   few enough inputs to make a table. */
+      unsigned long size = udp_table_size(port_count());
+      if (size == 0)
+	    return;
+
+      table_ = new unsigned char[size];
+      for (unsigned long idx = 0 ;  idx < size ;  idx += 1) {
+	    struct udp_levels_table cur;
+	    udp_table_levels(cur, idx, port_count());
+	    table_[idx] = test_levels(cur);
+      }
 }
 
 vvp_udp_seq_s::vvp_udp_seq_s(char*label, char*name__,
@@ -313,6 +394,9 @@ vvp_udp_seq_s::vvp_udp_seq_s(char*label, char*name__,
       nedges0_ = 0;
       nedges1_ = 0;
       nedgesL_ = 0;
+
+      levels_table_ = 0;
+      edges_table_ = 0;
 }
 
 vvp_udp_seq_s::~vvp_udp_seq_s()
@@ -324,6 +408,8 @@ vvp_udp_seq_s::~vvp_udp_seq_s()
       delete[] edges0_;
       delete[] edges1_;
       delete[] edgesL_;
+      delete[] levels_table_;
+      delete[] edges_table_;
 }
 
 void edge_based_on_char(struct udp_edges_table&cur, char chr, unsigned pos)
@@ -670,6 +756,51 @@ void vvp_udp_seq_s::compile_table(char**tab)
       assert(idx_edg1 == nedges1_);
       assert(idx_edgL == nedgesL_);
 
+	/* Now evaluate the rows for every value of the inputs and
+	   current output, and for every edge that can lead to each
+	   of those values, if there are few enough inputs to make
+	   tables. */
+      unsigned long size = udp_table_size(port_count()+1);
+      if (size == 0 || size*port_count()*3 > UDP_TABLE_LIMIT)
+	    return;
+
+      levels_table_ = new unsigned char[size];
+      edges_table_ = new unsigned char[size*port_count()*3];
+      for (unsigned long idx = 0 ;  idx < size ;  idx += 1) {
+	    struct udp_levels_table cur;
+	    udp_table_levels(cur, idx, port_count()+1);
+	    levels_table_[idx] = test_levels_(cur);
+
+	    for (unsigned pp = 0 ;  pp < port_count() ;  pp += 1) {
+		  unsigned long mask = 1UL << pp;
+		  unsigned cur_val = (idx / udp_table_size(pp)) % 3;
+		  for (unsigned val = 0 ;  val < 3 ;  val += 1) {
+			  /* Make the previous input by changing the
+			     edge position to the old value. */
+			struct udp_levels_table prev = cur;
+			prev.mask0 &= ~mask;
+			prev.mask1 &= ~mask;
+			prev.maskx &= ~mask;
+			switch (val) {
+			    case 0:
+			      prev.mask0 |= mask;
+			      break;
+			    case 1:
+			      prev.mask1 |= mask;
+			      break;
+			    default:
+			      prev.maskx |= mask;
+			      break;
+			}
+
+			unsigned char&ent = edges_table_[(idx*port_count()+pp)*3 + val];
+			if (val == cur_val)
+			      ent = BIT4_X;
+			else
+			      ent = test_edges_(cur, prev);
+		  }
+	    }
+      }
 }
 
 bool operator == (const udp_levels_table&a, const udp_levels_table&b)
@@ -705,6 +836,39 @@ vvp_bit4_t vvp_udp_seq_s::calculate_output(const udp_levels_table&cur,
 	    break;
       }
 
+      if (levels_table_) {
+	    unsigned long index = udp_table_index(cur_tmp, port_count()+1);
+	    vvp_bit4_t lev = (vvp_bit4_t) levels_table_[index];
+	    if (lev != BIT4_Z)
+		  return lev;
+
+	      /* Find the input that changed, and the value it had
+		 before. There is at most one. */
+	    unsigned long edge_mask = (cur.mask0 ^ prev.mask0) |
+				      (cur.maskx ^ prev.maskx) |
+				      (cur.mask1 ^ prev.mask1);
+	    edge_mask &= ~ (-1UL << port_count());
+	    if (edge_mask == 0)
+		  return BIT4_X;
+	    assert((edge_mask & (edge_mask-1)) == 0);
+
+	    unsigned edge_position = 0;
+	    while ((edge_mask&1) == 0) {
+		  edge_mask >>= 1;
+		  edge_position += 1;
+	    }
+
+	    edge_mask = 1UL << edge_position;
+	    unsigned val = 0;
+	    if (prev.mask1 & edge_mask)
+		  val = 1;
+	    else if (prev.maskx & edge_mask)
+		  val = 2;
+
+	    return (vvp_bit4_t)
+		  edges_table_[(index*port_count()+edge_position)*3 + val];
+      }
+
       vvp_bit4_t lev = test_levels_(cur_tmp);
       if (lev == BIT4_Z) {
 	    lev = test_edges_(cur_tmp, prev);
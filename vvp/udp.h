@@ -102,6 +102,14 @@ struct vvp_udp_s {
  *   ?  -- 0, x or 1
  *
  * Only 0, 1 and x characters are allowed in the output position.
+ *
+ * If the device has few enough inputs, compile_table also evaluates
+ * the rows for every possible input and saves the results in a table
+ * that is indexed directly by the input values. Each input is a base
+ * 3 digit of the index (0, 1 and x/z) with the first port the least
+ * significant. The table belongs to the definition, so all the
+ * instances share it. Devices with too many inputs for a table use
+ * the rows.
  */
 
 struct udp_levels_table {
@@ -131,6 +139,9 @@ class vvp_udp_comb_s : public vvp_udp_s {
       struct udp_levels_table*levels0_;
       struct udp_levels_table*levels1_;
       unsigned nlevels0_, nlevels1_;
+
+	// Output for every input value, or nil if too many inputs.
+      unsigned char*table_;
 };
 
 /*
@@ -166,6 +177,13 @@ class vvp_udp_comb_s : public vvp_udp_s {
  * position, and the edge_position the bit that has shifted. In the
  * edge case, the mask* members give the final position and the
  * edge_mask* bits the initial position of the bit.
+ *
+ * Like the combinational device, a sequential device with few enough
+ * inputs also gets lookup tables. The levels table is indexed by the
+ * inputs and the current output (the most significant digit) and
+ * holds the next output, or Z if no level row matches. The edges
+ * table has for each entry of the levels table an entry for each
+ * input and each value that input may have had before the edge.
  */
 struct udp_edges_table {
       unsigned long edge_position : 8;
@@ -208,6 +226,10 @@ class vvp_udp_seq_s : public vvp_udp_s {
       struct udp_edges_table*edgesL_;
       unsigned nedges0_, nedges1_, nedgesL_;
 
+	// Lookup tables compiled from the rows, or nil if too many
+	// inputs.
+      unsigned char*levels_table_;
+      unsigned char*edges_table_;
 };
 
 /*
@@ -764,6 +764,25 @@ void vvp_signal_value::get_signal_value(struct t_vpi_value*vp)
 	    break;
 	  }
 
+	  case _vpiRawFourStateVal: {
+	      // Point straight at the bits of the signal if they are
+	      // stored in a vector, and otherwise get a copy.
+	    const vvp_vector4_t*ref = vec4_value_ref();
+	    if (ref == 0) {
+		  vvp_vector4_t vec4;
+		  vec4_value(vec4);
+		  vpip_vec4_get_value(vec4, vec4.size(), false, vp);
+		  break;
+	    }
+	    s_vpi_rawval*raw = (s_vpi_rawval*)
+		  need_result_buf(sizeof(s_vpi_rawval), RBUF_VAL);
+	    raw->width = ref->size();
+	    raw->aval = ref->abits_words();
+	    raw->bval = ref->bbits_words();
+	    vp->value.misc = (char*)raw;
+	    break;
+	  }
+
 	  case vpiSuppressVal:
 	    break;
 
@@ -721,6 +721,32 @@ void vpip_vec4_get_value(const vvp_vector4_t&word_val, unsigned width,
 		break;
 	  }
 
+	  case _vpiRawFourStateVal: {
+		  // The word_val may be a temporary, so copy the words
+		  // into the result buffer after the s_vpi_rawval.
+		vvp_vector4_t tmp;
+		const vvp_vector4_t*src = &word_val;
+		if (word_val.size() != width) {
+		      tmp = vvp_vector4_t(word_val, 0, width);
+		      src = &tmp;
+		}
+		unsigned nwords = (width + 8*sizeof(unsigned long) - 1)
+		                  / (8*sizeof(unsigned long));
+		if (nwords == 0) nwords = 1;
+		s_vpi_rawval*raw = (s_vpi_rawval*)
+			need_result_buf(sizeof(s_vpi_rawval) +
+			                2*nwords*sizeof(unsigned long), RBUF_VAL);
+		unsigned long*words = (unsigned long*)(raw + 1);
+		memcpy(words, src->abits_words(), nwords*sizeof(unsigned long));
+		memcpy(words+nwords, src->bbits_words(),
+		       nwords*sizeof(unsigned long));
+		raw->width = width;
+		raw->aval = words;
+		raw->bval = words + nwords;
+		vp->value.misc = (char*)raw;
+		break;
+	  }
+
 	  case vpiObjTypeVal:
 	    // Use the following case to actually set the value!
 	    vp->format = vpiVectorVal;
@@ -751,6 +751,10 @@ static void signal_get_value(vpiHandle ref, s_vpi_value*vp)
 	    format_vpiVectorVal(vsig, 0, wid, vp);
 	    break;
 
+	  case _vpiRawFourStateVal:
+	    vsig->get_signal_value(vp);
+	    break;
+
 	  case vpiRealVal:
 	    format_vpiRealVal(vsig, 0, wid, rfp->signed_flag, vp);
 	    break;
@@ -1295,6 +1299,21 @@ static void PV_get_value(vpiHandle ref, p_vpi_value vp)
 	    format_vpiVectorVal(sig, PV_get_base(rfp), rfp->width, vp);
 	    break;
 
+	  case _vpiRawFourStateVal: {
+		// Bits of the part that are outside the signal are X.
+	      vvp_vector4_t full;
+	      sig->vec4_value(full);
+	      int base = PV_get_base(rfp);
+	      vvp_vector4_t part (rfp->width, BIT4_X);
+	      for (unsigned idx = 0 ;  idx < rfp->width ;  idx += 1) {
+		    long bit = base + (long)idx;
+		    if (bit >= 0 && bit < (long)full.size())
+			  part.set_bit(idx, full.value(bit));
+	      }
+	      vpip_vec4_get_value(part, rfp->width, false, vp);
+	      break;
+	  }
+
 	  case vpiRealVal:
 	    format_vpiRealVal(sig, PV_get_base(rfp), rfp->width, 0, vp);
 	    break;
@@ -28,6 +28,7 @@
 # include  "vvp_cobject.h"
 # include  "vvp_darray.h"
 # include  "class_type.h"
+# include  "profile.h"
 #ifdef CHECK_WITH_VALGRIND
 # include  "vvp_cleanup.h"
 #endif
@@ -119,44 +120,50 @@ struct vthread_s {
       vector<unsigned> args_vec4;
 
     private:
+	// The vec4 stack is stack_vec4_size_ deep. The vector itself
+	// is never shrunk, so the entries past the top keep the
+	// storage of popped values, and pushing a value into such an
+	// entry does not need to allocate if the word count matches.
       vector<vvp_vector4_t>stack_vec4_;
+      size_t stack_vec4_size_;
     public:
       inline vvp_vector4_t pop_vec4(void)
       {
-	    assert(! stack_vec4_.empty());
-	    vvp_vector4_t val = stack_vec4_.back();
-	    stack_vec4_.pop_back();
+	    assert(stack_vec4_size_ > 0);
+	    stack_vec4_size_ -= 1;
+	    vvp_vector4_t val;
+	    val.swap(stack_vec4_[stack_vec4_size_]);
 	    return val;
       }
       inline void push_vec4(const vvp_vector4_t&val)
       {
-	    stack_vec4_.push_back(val);
+	    if (stack_vec4_size_ < stack_vec4_.size())
+		  stack_vec4_[stack_vec4_size_] = val;
+	    else
+		  stack_vec4_.push_back(val);
+	    stack_vec4_size_ += 1;
       }
-      inline const vvp_vector4_t& peek_vec4(unsigned depth)
+      inline vvp_vector4_t& peek_vec4(unsigned depth)
       {
-	    unsigned size = stack_vec4_.size();
-	    assert(depth < size);
-	    unsigned use_index = size-1-depth;
+	    assert(depth < stack_vec4_size_);
+	    size_t use_index = stack_vec4_size_-1-depth;
 	    return stack_vec4_[use_index];
       }
       inline vvp_vector4_t& peek_vec4(void)
       {
-	    unsigned use_index = stack_vec4_.size();
-	    assert(use_index >= 1);
-	    return stack_vec4_[use_index-1];
+	    assert(stack_vec4_size_ >= 1);
+	    return stack_vec4_[stack_vec4_size_-1];
       }
       inline void poke_vec4(unsigned depth, const vvp_vector4_t&val)
       {
-	    assert(depth < stack_vec4_.size());
-	    unsigned use_index = stack_vec4_.size()-1-depth;
+	    assert(depth < stack_vec4_size_);
+	    size_t use_index = stack_vec4_size_-1-depth;
 	    stack_vec4_[use_index] = val;
       }
       inline void pop_vec4(unsigned cnt)
       {
-	    while (cnt > 0) {
-		  stack_vec4_.pop_back();
-		  cnt -= 1;
-	    }
+	    assert(cnt <= stack_vec4_size_);
+	    stack_vec4_size_ -= cnt;
       }
 
 
@@ -300,12 +307,12 @@ struct vthread_s {
       inline void cleanup()
       {
 	    if (i_was_disabled) {
-		  stack_vec4_.clear();
+		  stack_vec4_size_ = 0;
 		  stack_real_.clear();
 		  stack_str_.clear();
 		  pop_object(stack_obj_size_);
 	    }
-	    assert(stack_vec4_.empty());
+	    assert(stack_vec4_size_ == 0);
 	    assert(stack_real_.empty());
 	    assert(stack_str_.empty());
 	    assert(stack_obj_size_ == 0);
@@ -314,6 +321,7 @@ struct vthread_s {
 
 inline vthread_s::vthread_s()
 {
+      stack_vec4_size_ = 0;
       stack_obj_size_ = 0;
 }
 
@@ -327,8 +335,8 @@ void vthread_s::debug_dump(ostream&fd, const char*label)
 	    fd << flags[idx];
       fd << endl;
       fd << "**** vec4 stack..." << endl;
-      for (size_t idx = stack_vec4_.size() ; idx > 0 ; idx -= 1)
-	    fd << "    " << (stack_vec4_.size()-idx) << ": " << stack_vec4_[idx-1] << endl;
+      for (size_t idx = stack_vec4_size_ ; idx > 0 ; idx -= 1)
+	    fd << "    " << (stack_vec4_size_-idx) << ": " << stack_vec4_[idx-1] << endl;
       fd << "**** str stack (" << stack_str_.size() << ")..." << endl;
       fd << "**** obj stack (" << stack_obj_size_ << ")..." << endl;
       fd << "**** args_vec4 array (" << args_vec4.size() << ")..." << endl;
@@ -687,6 +695,10 @@ void vthread_delay_delete()
  */
 void vthread_run(vthread_t thr)
 {
+	// Functions are run to completion by calling vthread_run from
+	// within the calling thread, so restore the profile scope.
+      __vpiScope*save_profile_scope = vvp_profile_scope;
+
       while (thr != 0) {
 	    vthread_t tmp = thr->wait_next;
 	    thr->wait_next = 0;
@@ -695,6 +707,7 @@ void vthread_run(vthread_t thr)
 	    thr->is_scheduled = 0;
 
             running_thread = thr;
+	    vvp_profile_scope = thr->parent_scope;
 
 	    for (;;) {
 		  vvp_code_t cp = thr->pc;
@@ -711,6 +724,7 @@ void vthread_run(vthread_t thr)
 	    thr = tmp;
       }
       running_thread = 0;
+      vvp_profile_scope = save_profile_scope;
 }
 
 /*
@@ -790,10 +804,11 @@ bool of_ALLOC(vthread_t thr, vvp_code_t cp)
 
 bool of_AND(vthread_t thr, vvp_code_t)
 {
-      vvp_vector4_t valb = thr->pop_vec4();
-      vvp_vector4_t&vala = thr->peek_vec4();
+      const vvp_vector4_t&valb = thr->peek_vec4(0);
+      vvp_vector4_t&vala = thr->peek_vec4(1);
       assert(vala.size() == valb.size());
       vala &= valb;
+      thr->pop_vec4(1);
       return true;
 }
 
@@ -859,14 +874,15 @@ static void get_immediate_rval(vvp_code_t cp, vvp_vector4_t&val)
  */
 bool of_ADD(vthread_t thr, vvp_code_t)
 {
-      vvp_vector4_t r = thr->pop_vec4();
+      const vvp_vector4_t&r = thr->peek_vec4(0);
 	// Rather then pop l, use it directly from the stack. When we
 	// assign to 'l', that will edit the top of the stack, which
 	// replaces a pop and a pull.
-      vvp_vector4_t&l = thr->peek_vec4();
+      vvp_vector4_t&l = thr->peek_vec4(1);
 
       l.add(r);
 
+      thr->pop_vec4(1);
       return true;
 }
 
@@ -1273,18 +1289,12 @@ bool of_ASSIGN_WRE(vthread_t thr, vvp_code_t cp)
 
 bool of_BLEND(vthread_t thr, vvp_code_t)
 {
-      vvp_vector4_t vala = thr->pop_vec4();
-      vvp_vector4_t valb = thr->pop_vec4();
+      const vvp_vector4_t&vala = thr->peek_vec4(0);
+      vvp_vector4_t&valb = thr->peek_vec4(1);
       assert(vala.size() == valb.size());
 
-      for (unsigned idx = 0 ; idx < vala.size() ; idx += 1) {
-	    if (vala.value(idx) == valb.value(idx))
-		  continue;
-
-	    vala.set_bit(idx, BIT4_X);
-      }
-
-      thr->push_vec4(vala);
+      valb.blend(vala);
+      thr->pop_vec4(1);
       return true;
 }
 
@@ -4210,13 +4220,14 @@ bool of_MOV_WU(vthread_t thr, vvp_code_t cp)
  */
 bool of_MUL(vthread_t thr, vvp_code_t)
 {
-      vvp_vector4_t r = thr->pop_vec4();
+      const vvp_vector4_t&r = thr->peek_vec4(0);
 	// Rather then pop l, use it directly from the stack. When we
 	// assign to 'l', that will edit the top of the stack, which
 	// replaces a pop and a pull.
-      vvp_vector4_t&l = thr->peek_vec4();
+      vvp_vector4_t&l = thr->peek_vec4(1);
 
       l.mul(r);
+      thr->pop_vec4(1);
       return true;
 }
 
@@ -4253,17 +4264,12 @@ bool of_MUL_WR(vthread_t thr, vvp_code_t)
 
 bool of_NAND(vthread_t thr, vvp_code_t)
 {
-      vvp_vector4_t valr = thr->pop_vec4();
-      vvp_vector4_t&vall = thr->peek_vec4();
+      const vvp_vector4_t&valr = thr->peek_vec4(0);
+      vvp_vector4_t&vall = thr->peek_vec4(1);
       assert(vall.size() == valr.size());
-      unsigned wid = vall.size();
-
-      for (unsigned idx = 0 ; idx < wid ; idx += 1) {
-	    vvp_bit4_t lb = vall.value(idx);
-	    vvp_bit4_t rb = valr.value(idx);
-	    vall.set_bit(idx, ~(lb&rb));
-      }
-
+      vall &= valr;
+      vall.invert();
+      thr->pop_vec4(1);
       return true;
 }
 
@@ -4344,25 +4350,8 @@ bool of_NOOP(vthread_t, vvp_code_t)
  */
 bool of_NORR(vthread_t thr, vvp_code_t)
 {
-      vvp_vector4_t val = thr->pop_vec4();
-
-      vvp_bit4_t lb = BIT4_1;
-
-      for (unsigned idx = 0 ;  idx < val.size() ;  idx += 1) {
-
-	    vvp_bit4_t rb = val.value(idx);
-	    if (rb == BIT4_1) {
-		  lb = BIT4_0;
-		  break;
-	    }
-
-	    if (rb != BIT4_0)
-		  lb = BIT4_X;
-      }
-
-      vvp_vector4_t res (1, lb);
-      thr->push_vec4(res);
-
+      vvp_vector4_t&val = thr->peek_vec4();
+      val = vvp_vector4_t(1, ~val.or_reduce());
       return true;
 }
 
@@ -4381,24 +4370,8 @@ bool of_NULL(vthread_t thr, vvp_code_t)
  */
 bool of_ANDR(vthread_t thr, vvp_code_t)
 {
-      vvp_vector4_t val = thr->pop_vec4();
-
-      vvp_bit4_t lb = BIT4_1;
-
-      for (unsigned idx = 0 ; idx < val.size() ; idx += 1) {
-	    vvp_bit4_t rb = val.value(idx);
-	    if (rb == BIT4_0) {
-		  lb = BIT4_0;
-		  break;
-	    }
-
-	    if (rb != 1)
-		  lb = BIT4_X;
-      }
-
-      vvp_vector4_t res (1, lb);
-      thr->push_vec4(res);
-
+      vvp_vector4_t&val = thr->peek_vec4();
+      val = vvp_vector4_t(1, val.and_reduce());
       return true;
 }
 
@@ -4407,24 +4380,8 @@ bool of_ANDR(vthread_t thr, vvp_code_t)
  */
 bool of_NANDR(vthread_t thr, vvp_code_t)
 {
-      vvp_vector4_t val = thr->pop_vec4();
-
-      vvp_bit4_t lb = BIT4_0;
-      for (unsigned idx = 0 ; idx < val.size() ; idx += 1) {
-
-	    vvp_bit4_t rb = val.value(idx);
-	    if (rb == BIT4_0) {
-		  lb = BIT4_1;
-		  break;
-	    }
-
-	    if (rb != BIT4_1)
-		  lb = BIT4_X;
-      }
-
-      vvp_vector4_t res (1, lb);
-      thr->push_vec4(res);
-
+      vvp_vector4_t&val = thr->peek_vec4();
+      val = vvp_vector4_t(1, ~val.and_reduce());
       return true;
 }
 
@@ -4433,22 +4390,8 @@ bool of_NANDR(vthread_t thr, vvp_code_t)
  */
 bool of_ORR(vthread_t thr, vvp_code_t)
 {
-      vvp_vector4_t val = thr->pop_vec4();
-
-      vvp_bit4_t lb = BIT4_0;
-      for (unsigned idx = 0 ; idx < val.size() ; idx += 1) {
-	    vvp_bit4_t rb = val.value(idx);
-	    if (rb == BIT4_1) {
-		  lb = BIT4_1;
-		  break;
-	    }
-
-	    if (rb != BIT4_0)
-		  lb = BIT4_X;
-      }
-
-      vvp_vector4_t res (1, lb);
-      thr->push_vec4(res);
+      vvp_vector4_t&val = thr->peek_vec4();
+      val = vvp_vector4_t(1, val.or_reduce());
       return true;
 }
 
@@ -4457,22 +4400,8 @@ bool of_ORR(vthread_t thr, vvp_code_t)
  */
 bool of_XORR(vthread_t thr, vvp_code_t)
 {
-      vvp_vector4_t val = thr->pop_vec4();
-
-      vvp_bit4_t lb = BIT4_0;
-      for (unsigned idx = 0 ; idx < val.size() ; idx += 1) {
-
-	    vvp_bit4_t rb = val.value(idx);
-	    if (rb == BIT4_1)
-		  lb = ~lb;
-	    else if (rb != BIT4_0) {
-		  lb = BIT4_X;
-		  break;
-	    }
-      }
-
-      vvp_vector4_t res (1, lb);
-      thr->push_vec4(res);
+      vvp_vector4_t&val = thr->peek_vec4();
+      val = vvp_vector4_t(1, val.xor_reduce());
       return true;
 }
 
@@ -4481,22 +4410,8 @@ bool of_XORR(vthread_t thr, vvp_code_t)
  */
 bool of_XNORR(vthread_t thr, vvp_code_t)
 {
-      vvp_vector4_t val = thr->pop_vec4();
-
-      vvp_bit4_t lb = BIT4_1;
-      for (unsigned idx = 0 ; idx < val.size() ; idx += 1) {
-
-	    vvp_bit4_t rb = val.value(idx);
-	    if (rb == BIT4_1)
-		  lb = ~lb;
-	    else if (rb != BIT4_0) {
-		  lb = BIT4_X;
-		  break;
-	    }
-      }
-
-      vvp_vector4_t res (1, lb);
-      thr->push_vec4(res);
+      vvp_vector4_t&val = thr->peek_vec4();
+      val = vvp_vector4_t(1, ~val.xor_reduce());
       return true;
 }
 
@@ -4505,9 +4420,10 @@ bool of_XNORR(vthread_t thr, vvp_code_t)
  */
 bool of_OR(vthread_t thr, vvp_code_t)
 {
-      vvp_vector4_t valb = thr->pop_vec4();
-      vvp_vector4_t&vala = thr->peek_vec4();
+      const vvp_vector4_t&valb = thr->peek_vec4(0);
+      vvp_vector4_t&vala = thr->peek_vec4(1);
       vala |= valb;
+      thr->pop_vec4(1);
       return true;
 }
 
@@ -4516,17 +4432,12 @@ bool of_OR(vthread_t thr, vvp_code_t)
  */
 bool of_NOR(vthread_t thr, vvp_code_t)
 {
-      vvp_vector4_t valr = thr->pop_vec4();
-      vvp_vector4_t&vall = thr->peek_vec4();
+      const vvp_vector4_t&valr = thr->peek_vec4(0);
+      vvp_vector4_t&vall = thr->peek_vec4(1);
       assert(vall.size() == valr.size());
-      unsigned wid = vall.size();
-
-      for (unsigned idx = 0 ; idx < wid ; idx += 1) {
-	    vvp_bit4_t lb = vall.value(idx);
-	    vvp_bit4_t rb = valr.value(idx);
-	    vall.set_bit(idx, ~(lb|rb));
-      }
-
+      vall |= valr;
+      vall.invert();
+      thr->pop_vec4(1);
       return true;
 }
 
@@ -5898,10 +5809,11 @@ bool of_STORE_VEC4A(vthread_t thr, vvp_code_t cp)
  */
 bool of_SUB(vthread_t thr, vvp_code_t)
 {
-      vvp_vector4_t r = thr->pop_vec4();
-      vvp_vector4_t&l = thr->peek_vec4();
+      const vvp_vector4_t&r = thr->peek_vec4(0);
+      vvp_vector4_t&l = thr->peek_vec4(1);
 
       l.sub(r);
+      thr->pop_vec4(1);
       return true;
 }
 
@@ -6144,18 +6056,12 @@ bool of_WAIT_FORK(vthread_t thr, vvp_code_t)
  */
 bool of_XNOR(vthread_t thr, vvp_code_t)
 {
-      vvp_vector4_t valr = thr->pop_vec4();
-      vvp_vector4_t&vall = thr->peek_vec4();
+      const vvp_vector4_t&valr = thr->peek_vec4(0);
+      vvp_vector4_t&vall = thr->peek_vec4(1);
       assert(vall.size() == valr.size());
-      unsigned wid = vall.size();
-
-      for (unsigned idx = 0 ;  idx < wid ;  idx += 1) {
-
-	    vvp_bit4_t lb = vall.value(idx);
-	    vvp_bit4_t rb = valr.value(idx);
-	    vall.set_bit(idx, ~(lb ^ rb));
-      }
-
+      vall ^= valr;
+      vall.invert();
+      thr->pop_vec4(1);
       return true;
 }
 
@@ -6164,18 +6070,11 @@ bool of_XNOR(vthread_t thr, vvp_code_t)
  */
 bool of_XOR(vthread_t thr, vvp_code_t)
 {
-      vvp_vector4_t valr = thr->pop_vec4();
-      vvp_vector4_t&vall = thr->peek_vec4();
+      const vvp_vector4_t&valr = thr->peek_vec4(0);
+      vvp_vector4_t&vall = thr->peek_vec4(1);
       assert(vall.size() == valr.size());
-      unsigned wid = vall.size();
-
-      for (unsigned idx = 0 ;  idx < wid ;  idx += 1) {
-
-	    vvp_bit4_t lb = vall.value(idx);
-	    vvp_bit4_t rb = valr.value(idx);
-	    vall.set_bit(idx, lb ^ rb);
-      }
-
+      vall ^= valr;
+      thr->pop_vec4(1);
       return true;
 }
 
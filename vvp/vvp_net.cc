@@ -33,6 +33,7 @@
 # include  <climits>
 # include  <cmath>
 # include  <cassert>
+# include  <vector>
 #ifdef CHECK_WITH_VALGRIND
 # include  <valgrind/memcheck.h>
 # include  <map>
@@ -57,10 +58,16 @@ static vvp_net_t **vvp_net_pool = NULL;
 static unsigned vvp_net_pool_count = 0;
 #endif
 static size_t vvp_net_alloc_remaining = 0;
+// Keep a list of the alloc chunks so that vvp_net_compact_fanout can
+// find all the vvp_net_t objects.
+static vector<vvp_net_t*> vvp_net_chunk_list;
 // For statistics, count the vvp_nets allocated and the bytes of alloc
 // chunks allocated.
 unsigned long count_vvp_nets = 0;
 size_t size_vvp_nets = 0;
+// Nets that use the compact fan-out table, and the size of the table.
+unsigned long count_fanout_nets = 0;
+size_t size_fanout_table = 0;
 
 void* vvp_net_t::operator new (size_t size)
 {
@@ -69,6 +76,7 @@ void* vvp_net_t::operator new (size_t size)
 	    vvp_net_alloc_table = ::new vvp_net_t[VVP_NET_CHUNK];
 	    vvp_net_alloc_remaining = VVP_NET_CHUNK;
 	    size_vvp_nets += size*VVP_NET_CHUNK;
+	    vvp_net_chunk_list.push_back(vvp_net_alloc_table);
 #ifdef CHECK_WITH_VALGRIND
 	    VALGRIND_MAKE_MEM_NOACCESS(vvp_net_alloc_table, size*VVP_NET_CHUNK);
 	    VALGRIND_CREATE_MEMPOOL(vvp_net_alloc_table, 0, 0);
@@ -192,6 +200,7 @@ vvp_net_t::vvp_net_t()
 {
       fun = 0;
       fil = 0;
+      fanout_ = 0;
 }
 
 void vvp_net_t::link(vvp_net_ptr_t port_to_link)
@@ -199,6 +208,8 @@ void vvp_net_t::link(vvp_net_ptr_t port_to_link)
       vvp_net_t*net = port_to_link.ptr();
       net->port[port_to_link.port()] = out_;
       out_ = port_to_link;
+	// The compact copy of the fan-out is now stale.
+      fanout_ = 0;
 }
 
 /*
@@ -212,6 +223,8 @@ void vvp_net_t::unlink(vvp_net_ptr_t dst_ptr)
       vvp_net_t*net = dst_ptr.ptr();
       unsigned net_port = dst_ptr.port();
 
+      fanout_ = 0;
+
       if (out_ == dst_ptr) {
 	      /* If the drive fan-out list starts with this pointer,
 		 then the unlink is easy. Pull the list forward. */
@@ -235,6 +248,71 @@ void vvp_net_t::unlink(vvp_net_ptr_t dst_ptr)
       net->port[net_port] = vvp_net_ptr_t(0,0);
 }
 
+/*
+ * The compact fan-out table holds a nil terminated copy of each fan-out
+ * list that has more than one entry. The lists are copied in the
+ * order the nets were allocated, and each list keeps the order of the
+ * chain, so values are delivered in the same order either way. The
+ * table is never freed: a net that is relinked at run time just stops
+ * using its entry, and a send that is in progress can finish with it.
+ */
+static vvp_net_ptr_t*vvp_fanout_table = 0;
+
+void vvp_net_compact_fanout(void)
+{
+      assert(vvp_fanout_table == 0);
+
+      size_t count = 0;
+      for (size_t cdx = 0 ; cdx < vvp_net_chunk_list.size() ; cdx += 1) {
+	    vvp_net_t*chunk = vvp_net_chunk_list[cdx];
+	    size_t used = VVP_NET_CHUNK;
+	    if (cdx+1 == vvp_net_chunk_list.size())
+		  used -= vvp_net_alloc_remaining;
+
+	    for (size_t idx = 0 ; idx < used ; idx += 1) {
+		  vvp_net_ptr_t cur = chunk[idx].out_;
+		  if (cur.nil() || cur.ptr()->port[cur.port()].nil())
+			continue;
+
+		  count_fanout_nets += 1;
+		  count += 1;
+		  while (! cur.nil()) {
+			count += 1;
+			cur = cur.ptr()->port[cur.port()];
+		  }
+	    }
+      }
+
+      if (count == 0)
+	    return;
+
+      vvp_fanout_table = new vvp_net_ptr_t[count];
+      size_fanout_table = count * sizeof(vvp_net_ptr_t);
+
+      vvp_net_ptr_t*fill = vvp_fanout_table;
+      for (size_t cdx = 0 ; cdx < vvp_net_chunk_list.size() ; cdx += 1) {
+	    vvp_net_t*chunk = vvp_net_chunk_list[cdx];
+	    size_t used = VVP_NET_CHUNK;
+	    if (cdx+1 == vvp_net_chunk_list.size())
+		  used -= vvp_net_alloc_remaining;
+
+	    for (size_t idx = 0 ; idx < used ; idx += 1) {
+		  vvp_net_ptr_t cur = chunk[idx].out_;
+		  if (cur.nil() || cur.ptr()->port[cur.port()].nil())
+			continue;
+
+		  chunk[idx].fanout_ = fill;
+		  while (! cur.nil()) {
+			*fill++ = cur;
+			cur = cur.ptr()->port[cur.port()];
+		  }
+		  *fill++ = vvp_net_ptr_t(0,0);
+	    }
+      }
+
+      assert(fill == vvp_fanout_table + count);
+}
+
 void vvp_net_t::count_drivers(unsigned idx, unsigned counts[4])
 {
       counts[0] = 0;
@@ -563,8 +641,10 @@ void vvp_send_vec8(vvp_net_ptr_t ptr, const vvp_vector8_t&val)
       while (vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next = cur->port[ptr.port()];
 
-	    if (cur->fun)
+	    if (cur->fun) {
+		  vvp_profile_hop_t hop (cur->fun);
 		  cur->fun->recv_vec8(ptr, val);
+	    }
 
 	    ptr = next;
       }
@@ -575,20 +655,48 @@ void vvp_send_real(vvp_net_ptr_t ptr, double val, vvp_context_t context)
       while (vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next = cur->port[ptr.port()];
 
-	    if (cur->fun)
+	    if (cur->fun) {
+		  vvp_profile_hop_t hop (cur->fun);
 		  cur->fun->recv_real(ptr, val, context);
+	    }
 
 	    ptr = next;
       }
 }
 
+void vvp_send_vec8(const vvp_net_ptr_t*ptr, const vvp_vector8_t&val)
+{
+      for ( ; ! ptr->nil() ; ptr += 1) {
+	    vvp_net_ptr_t dst = *ptr;
+	    vvp_net_t*cur = dst.ptr();
+	    if (cur->fun) {
+		  vvp_profile_hop_t hop (cur->fun);
+		  cur->fun->recv_vec8(dst, val);
+	    }
+      }
+}
+
+void vvp_send_real(const vvp_net_ptr_t*ptr, double val, vvp_context_t context)
+{
+      for ( ; ! ptr->nil() ; ptr += 1) {
+	    vvp_net_ptr_t dst = *ptr;
+	    vvp_net_t*cur = dst.ptr();
+	    if (cur->fun) {
+		  vvp_profile_hop_t hop (cur->fun);
+		  cur->fun->recv_real(dst, val, context);
+	    }
+      }
+}
+
 void vvp_send_long(vvp_net_ptr_t ptr, long val)
 {
       while (vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next = cur->port[ptr.port()];
 
-	    if (cur->fun)
+	    if (cur->fun) {
+		  vvp_profile_hop_t hop (cur->fun);
 		  cur->fun->recv_long(ptr, val);
+	    }
 
 	    ptr = next;
       }
@@ -600,8 +708,10 @@ void vvp_send_long_pv(vvp_net_ptr_t ptr, long val,
       while (vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next = cur->port[ptr.port()];
 
-	    if (cur->fun)
+	    if (cur->fun) {
+		  vvp_profile_hop_t hop (cur->fun);
 		  cur->fun->recv_long_pv(ptr, val, base, wid);
+	    }
 
 	    ptr = next;
       }
@@ -707,6 +817,22 @@ void vvp_vector4_t::copy_from_big_(const vvp_vector4_t&that)
 	    bbits_ptr_[idx] = that.bbits_ptr_[idx];
 }
 
+/*
+ * Copy the words of that vector into the words that are already
+ * allocated for this vector. The caller has checked that the vectors
+ * need the same number of words.
+ */
+void vvp_vector4_t::copy_words_big_(const vvp_vector4_t&that)
+{
+      size_ = that.size_;
+      unsigned words = (size_+BITS_PER_WORD-1) / BITS_PER_WORD;
+
+      for (unsigned idx = 0 ;  idx < words ;  idx += 1)
+	    abits_ptr_[idx] = that.abits_ptr_[idx];
+      for (unsigned idx = 0 ;  idx < words ;  idx += 1)
+	    bbits_ptr_[idx] = that.bbits_ptr_[idx];
+}
+
 /*
  * The copy_inverted_from_ method is just like the copy_from_ method,
  * except that we combine that with an invert. This allows the ~ and
@@ -1866,6 +1992,104 @@ char* vvp_vector4_t::as_string(char*buf, size_t buf_len) const
       return res;
 }
 
+/*
+ * Collect the bits of the vector into summary words: a bit is set in
+ * zero, one or xz if any bit of the vector in that position within a
+ * word is 0, 1 or X/Z, and parity is the xor of all the abits. The
+ * unused bits of the last word are masked off.
+ */
+void vvp_vector4_t::reduce_words_(unsigned long&zero, unsigned long&one,
+				  unsigned long&xz, unsigned long&parity) const
+{
+      zero = 0;
+      one = 0;
+      xz = 0;
+      parity = 0;
+
+      if (size_ == 0)
+	    return;
+
+      if (size_ <= BITS_PER_WORD) {
+	    unsigned long mask = (size_<BITS_PER_WORD)? (1UL<<size_)-1UL : -1UL;
+	    zero = ~abits_val_ & ~bbits_val_ & mask;
+	    one  =  abits_val_ & ~bbits_val_ & mask;
+	    xz   =  bbits_val_ & mask;
+	    parity = abits_val_ & mask;
+	    return;
+      }
+
+      unsigned remaining = size_;
+      unsigned idx = 0;
+      while (remaining > 0) {
+	    unsigned long mask = -1UL;
+	    if (remaining < BITS_PER_WORD) {
+		  mask = (1UL<<remaining) - 1UL;
+		  remaining = 0;
+	    } else {
+		  remaining -= BITS_PER_WORD;
+	    }
+
+	    unsigned long abits = abits_ptr_[idx];
+	    unsigned long bbits = bbits_ptr_[idx];
+	    zero |= ~abits & ~bbits & mask;
+	    one  |=  abits & ~bbits & mask;
+	    xz   |=  bbits & mask;
+	    parity ^= abits & mask;
+	    idx += 1;
+      }
+}
+
+vvp_bit4_t vvp_vector4_t::and_reduce() const
+{
+      unsigned long zero, one, xz, parity;
+      reduce_words_(zero, one, xz, parity);
+      if (zero) return BIT4_0;
+      if (xz) return BIT4_X;
+      return BIT4_1;
+}
+
+vvp_bit4_t vvp_vector4_t::or_reduce() const
+{
+      unsigned long zero, one, xz, parity;
+      reduce_words_(zero, one, xz, parity);
+      if (one) return BIT4_1;
+      if (xz) return BIT4_X;
+      return BIT4_0;
+}
+
+vvp_bit4_t vvp_vector4_t::xor_reduce() const
+{
+      unsigned long zero, one, xz, parity;
+      reduce_words_(zero, one, xz, parity);
+      if (xz) return BIT4_X;
+      for (unsigned shift = BITS_PER_WORD/2 ; shift > 0 ; shift /= 2)
+	    parity ^= parity >> shift;
+      return (parity & 1)? BIT4_1 : BIT4_0;
+}
+
+void vvp_vector4_t::blend(const vvp_vector4_t&that)
+{
+      assert(size_ == that.size_);
+
+	// A bit differs if either its abit or its bbit differs, and
+	// setting both bits makes it an X.
+      if (size_ <= BITS_PER_WORD) {
+	    unsigned long diff = (abits_val_ ^ that.abits_val_) |
+	                         (bbits_val_ ^ that.bbits_val_);
+	    abits_val_ |= diff;
+	    bbits_val_ |= diff;
+
+      } else {
+	    unsigned words = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
+	    for (unsigned idx = 0; idx < words ; idx += 1) {
+		  unsigned long diff = (abits_ptr_[idx] ^ that.abits_ptr_[idx]) |
+		                       (bbits_ptr_[idx] ^ that.bbits_ptr_[idx]);
+		  abits_ptr_[idx] |= diff;
+		  bbits_ptr_[idx] |= diff;
+	    }
+      }
+}
+
 void vvp_vector4_t::invert()
 {
       if (size_ <= BITS_PER_WORD) {
@@ -1948,6 +2172,29 @@ vvp_vector4_t& vvp_vector4_t::operator |= (const vvp_vector4_t&that)
       return *this;
 }
 
+vvp_vector4_t& vvp_vector4_t::operator ^= (const vvp_vector4_t&that)
+{
+	// Any X or Z bit in either operand makes the result bit X,
+	// and for 0/1 bits the bbits are zero, so the result is the
+	// xor of the abits with the X bits forced on. If neither
+	// operand has X or Z bits the bbits simply stay zero.
+      if (size_ <= BITS_PER_WORD) {
+	    unsigned long xz = bbits_val_ | that.bbits_val_;
+	    abits_val_ = (abits_val_ ^ that.abits_val_) | xz;
+	    bbits_val_ = xz;
+
+      } else {
+	    unsigned words = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
+	    for (unsigned idx = 0; idx < words ; idx += 1) {
+		  unsigned long xz = bbits_ptr_[idx] | that.bbits_ptr_[idx];
+		  abits_ptr_[idx] = (abits_ptr_[idx] ^ that.abits_ptr_[idx]) | xz;
+		  bbits_ptr_[idx] = xz;
+	    }
+      }
+
+      return *this;
+}
+
 /*
 * Add an integer to the vvp_vector4_t in place, bit by bit so that
 * there is no size limitations.
@@ -24,6 +24,7 @@
 # include  "vvp_vpi_callback.h"
 # include  "permaheap.h"
 # include  "vvp_object.h"
+# include  "profile.h"
 # include  <cstddef>
 # include  <cstdlib>
 # include  <cstring>
@@ -270,6 +271,10 @@ class vvp_vector4_t {
 
       ~vvp_vector4_t();
 
+	// Exchange the contents of this vector with that vector. This
+	// moves the bits without copying or allocating anything.
+      void swap(vvp_vector4_t&that);
+
       inline unsigned size() const { return size_; }
       void resize(unsigned new_size, vvp_bit4_t pad_bit = BIT4_X);
 
@@ -321,9 +326,28 @@ class vvp_vector4_t {
 	// Display the value into the buf as a string.
       char*as_string(char*buf, size_t buf_len) const;
 
+	// Get the words that hold the abits and bbits of the vector,
+	// 8*sizeof(unsigned long) bits per word. These point into the
+	// vector itself, so are only good until the vector changes.
+      const unsigned long*abits_words() const;
+      const unsigned long*bbits_words() const;
+
+	// Reduce the vector to a single bit in the Verilog way. These
+	// work a word at a time. An empty vector reduces to the
+	// identity of the operation.
+      vvp_bit4_t and_reduce() const;
+      vvp_bit4_t or_reduce() const;
+      vvp_bit4_t xor_reduce() const;
+
+	// Blend that vector into this one. Bits that are the same in
+	// both vectors keep their value, and all other bits become X.
+	// The vectors must be the same size.
+      void blend(const vvp_vector4_t&that);
+
       void invert();
       vvp_vector4_t& operator &= (const vvp_vector4_t&that);
       vvp_vector4_t& operator |= (const vvp_vector4_t&that);
+      vvp_vector4_t& operator ^= (const vvp_vector4_t&that);
       vvp_vector4_t& operator += (int64_t);
 
     private:
@@ -353,10 +377,15 @@ class vvp_vector4_t {
 	// the data from that object into this object.
       void copy_from_(const vvp_vector4_t&that);
       void copy_from_big_(const vvp_vector4_t&that);
+      void copy_words_big_(const vvp_vector4_t&that);
       void copy_inverted_from_(const vvp_vector4_t&that);
 
       void allocate_words_(unsigned long inita, unsigned long initb);
 
+	// Summarize the bits of the vector for the reduction methods.
+      void reduce_words_(unsigned long&zero, unsigned long&one,
+			 unsigned long&xz, unsigned long&parity) const;
+
 	// Values in the vvp_vector4_t are stored split across two
 	// arrays. For each bit in the vector, there is an abit and a
 	// bbit. the encoding of a vvp_vector4_t is:
@@ -424,14 +453,34 @@ inline vvp_vector4_t& vvp_vector4_t::operator= (const vvp_vector4_t&that)
       if (this == &that)
 	    return *this;
 
-      if (size_ > BITS_PER_WORD)
+      if (size_ > BITS_PER_WORD) {
+	      // If the words already allocated are the right number
+	      // for that vector, then reuse them.
+	    if (that.size_ > BITS_PER_WORD &&
+		(size_+BITS_PER_WORD-1)/BITS_PER_WORD ==
+		(that.size_+BITS_PER_WORD-1)/BITS_PER_WORD) {
+		  copy_words_big_(that);
+		  return *this;
+	    }
 	    delete[] abits_ptr_;
+      }
 
       copy_from_(that);
 
       return *this;
 }
 
+inline void vvp_vector4_t::swap(vvp_vector4_t&that)
+{
+	// The active member of the word unions depends on the size,
+	// so exchange the objects as a whole. There are no pointers
+	// into the objects themselves, so this is safe.
+      char tmp[sizeof(vvp_vector4_t)];
+      memcpy(tmp, (void*)this, sizeof tmp);
+      memcpy((void*)this, (void*)&that, sizeof tmp);
+      memcpy((void*)&that, tmp, sizeof tmp);
+}
+
 inline void vvp_vector4_t::copy_from_(const vvp_vector4_t&that)
 {
       size_ = that.size_;
@@ -443,6 +492,16 @@ inline void vvp_vector4_t::copy_from_(const vvp_vector4_t&that)
       }
 }
 
+inline const unsigned long*vvp_vector4_t::abits_words() const
+{
+      return size_ > BITS_PER_WORD? abits_ptr_ : &abits_val_;
+}
+
+inline const unsigned long*vvp_vector4_t::bbits_words() const
+{
+      return size_ > BITS_PER_WORD? bbits_ptr_ : &bbits_val_;
+}
+
 inline vvp_bit4_t vvp_vector4_t::value(unsigned idx) const
 {
       if (idx >= size_)
@@ -1108,6 +1167,13 @@ template <class T> ostream& operator << (ostream&out, vvp_sub_pointer_t<T> val)
  * all the fan-out chain, delivering the specified value. The send_*()
  * methods of the vvp_net_t class are similar, but they follow the
  * output, possibly filtered, from the vvp_net_t.
+ *
+ * Following the chain touches each receiver in turn just to find the
+ * next, so after the design is compiled the fan-out lists with more
+ * then one entry are also copied into a single array, and the send_*()
+ * methods scan that copy instead. The chain remains the master copy:
+ * the link() and unlink() methods edit the chain and drop the compact
+ * copy, so that net goes back to following the chain.
  */
 class vvp_net_t {
     public:
@@ -1154,8 +1220,21 @@ class vvp_net_t {
     public: // Method to support $countdrivers
       void count_drivers(unsigned idx, unsigned counts[4]);
 
+      friend void vvp_net_compact_fanout(void);
+
+    private: // Deliver output to the fan-out.
+      void out_vec4_(const vvp_vector4_t&val, vvp_context_t context);
+      void out_vec4_pv_(const vvp_vector4_t&val,
+			unsigned base, unsigned wid, unsigned vwid,
+			vvp_context_t context);
+      void out_vec8_(const vvp_vector8_t&val);
+      void out_real_(double val, vvp_context_t context);
+
     private:
       vvp_net_ptr_t out_;
+	// If not nil, this points to a copy of the fan-out list in
+	// the compact fan-out table, terminated by a nil pointer.
+      const vvp_net_ptr_t*fanout_;
 
     public: // Need a better new for these objects.
       static void* operator new(std::size_t size);
@@ -1596,13 +1675,42 @@ class vvp_wide_fun_t : public vvp_net_fun_t {
 };
 
 
+/*
+ * While the profiler is running, samples taken while a functor
+ * receives a value are charged to the type of that functor. The
+ * previous type is restored when the functor returns, so a sample
+ * taken later in the same propagation is charged to the sender.
+ */
+class vvp_profile_hop_t {
+    public:
+      explicit inline vvp_profile_hop_t(vvp_net_fun_t*fun)
+      : active_(vvp_profile_flag), save_(0)
+      { if (active_) {
+		  save_ = vvp_profile_type;
+		  vvp_profile_type = &typeid(*fun);
+	    }
+      }
+      inline ~vvp_profile_hop_t()
+      { if (active_) vvp_profile_type = save_; }
+
+    private:
+      bool active_;
+      const std::type_info*save_;
+
+    private: // not implemented
+      vvp_profile_hop_t(const vvp_profile_hop_t&);
+      vvp_profile_hop_t& operator= (const vvp_profile_hop_t&);
+};
+
 inline void vvp_send_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&val, vvp_context_t context)
 {
       while (class vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next = cur->port[ptr.port()];
 
-	    if (cur->fun)
+	    if (cur->fun) {
+		  vvp_profile_hop_t hop (cur->fun);
 		  cur->fun->recv_vec4(ptr, val, context);
+	    }
 
 	    ptr = next;
       }
@@ -1620,8 +1728,10 @@ inline void vvp_send_string(vvp_net_ptr_t ptr, const std::string&val, vvp_contex
       while (vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next = cur->port[ptr.port()];
 
-	    if (cur->fun)
+	    if (cur->fun) {
+		  vvp_profile_hop_t hop (cur->fun);
 		  cur->fun->recv_string(ptr, val, context);
+	    }
 
 	    ptr = next;
       }
@@ -1632,8 +1742,10 @@ inline void vvp_send_object(vvp_net_ptr_t ptr, vvp_object_t val, vvp_context_t c
       while (vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next = cur->port[ptr.port()];
 
-	    if (cur->fun)
+	    if (cur->fun) {
+		  vvp_profile_hop_t hop (cur->fun);
 		  cur->fun->recv_object(ptr, val, context);
+	    }
 
 	    ptr = next;
       }
@@ -1665,8 +1777,10 @@ inline void vvp_send_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&val,
       while (class vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next = cur->port[ptr.port()];
 
-	    if (cur->fun)
+	    if (cur->fun) {
+		  vvp_profile_hop_t hop (cur->fun);
 		  cur->fun->recv_vec4_pv(ptr, val, base, wid, vwid, context);
+	    }
 
 	    ptr = next;
       }
@@ -1678,17 +1792,94 @@ inline void vvp_send_vec8_pv(vvp_net_ptr_t ptr, const vvp_vector8_t&val,
       while (class vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next = cur->port[ptr.port()];
 
-	    if (cur->fun)
+	    if (cur->fun) {
+		  vvp_profile_hop_t hop (cur->fun);
 		  cur->fun->recv_vec8_pv(ptr, val, base, wid, vwid);
+	    }
 
 	    ptr = next;
       }
 }
 
+/*
+ * These versions take a nil terminated array of destination ports,
+ * as found in the compact fan-out table.
+ */
+inline void vvp_send_vec4(const vvp_net_ptr_t*ptr, const vvp_vector4_t&val,
+			  vvp_context_t context)
+{
+      for ( ; ! ptr->nil() ; ptr += 1) {
+	    vvp_net_ptr_t dst = *ptr;
+	    vvp_net_t*cur = dst.ptr();
+	    if (cur->fun) {
+		  vvp_profile_hop_t hop (cur->fun);
+		  cur->fun->recv_vec4(dst, val, context);
+	    }
+      }
+}
+
+inline void vvp_send_vec4_pv(const vvp_net_ptr_t*ptr, const vvp_vector4_t&val,
+			     unsigned base, unsigned wid, unsigned vwid,
+			     vvp_context_t context)
+{
+      for ( ; ! ptr->nil() ; ptr += 1) {
+	    vvp_net_ptr_t dst = *ptr;
+	    vvp_net_t*cur = dst.ptr();
+	    if (cur->fun) {
+		  vvp_profile_hop_t hop (cur->fun);
+		  cur->fun->recv_vec4_pv(dst, val, base, wid, vwid, context);
+	    }
+      }
+}
+
+extern void vvp_send_vec8(const vvp_net_ptr_t*ptr, const vvp_vector8_t&val);
+extern void vvp_send_real(const vvp_net_ptr_t*ptr, double val,
+                          vvp_context_t context);
+
+/*
+ * Copy all the fan-out lists with more than one entry into the
+ * compact fan-out table. This is called once the netlist is complete.
+ */
+extern void vvp_net_compact_fanout(void);
+
+inline void vvp_net_t::out_vec4_(const vvp_vector4_t&val, vvp_context_t context)
+{
+      if (fanout_)
+	    vvp_send_vec4(fanout_, val, context);
+      else
+	    vvp_send_vec4(out_, val, context);
+}
+
+inline void vvp_net_t::out_vec4_pv_(const vvp_vector4_t&val,
+				    unsigned base, unsigned wid, unsigned vwid,
+				    vvp_context_t context)
+{
+      if (fanout_)
+	    vvp_send_vec4_pv(fanout_, val, base, wid, vwid, context);
+      else
+	    vvp_send_vec4_pv(out_, val, base, wid, vwid, context);
+}
+
+inline void vvp_net_t::out_vec8_(const vvp_vector8_t&val)
+{
+      if (fanout_)
+	    vvp_send_vec8(fanout_, val);
+      else
+	    vvp_send_vec8(out_, val);
+}
+
+inline void vvp_net_t::out_real_(double val, vvp_context_t context)
+{
+      if (fanout_)
+	    vvp_send_real(fanout_, val, context);
+      else
+	    vvp_send_real(out_, val, context);
+}
+
 inline void vvp_net_t::send_vec4(const vvp_vector4_t&val, vvp_context_t context)
 {
       if (fil == 0) {
-	    vvp_send_vec4(out_, val, context);
+	    out_vec4_(val, context);
 	    return;
       }
 
@@ -1697,10 +1888,10 @@ inline void vvp_net_t::send_vec4(const vvp_vector4_t&val, vvp_context_t context)
 	  case vvp_net_fil_t::STOP:
 	    break;
 	  case vvp_net_fil_t::PROP:
-	    vvp_send_vec4(out_, val, context);
+	    out_vec4_(val, context);
 	    break;
 	  case vvp_net_fil_t::REPL:
-	    vvp_send_vec4(out_, rep, context);
+	    out_vec4_(rep, context);
 	    break;
       }
 }
@@ -1710,7 +1901,7 @@ inline void vvp_net_t::send_vec4_pv(const vvp_vector4_t&val,
 				    vvp_context_t context)
 {
       if (fil == 0) {
-	    vvp_send_vec4_pv(out_, val, base, wid, vwid, context);
+	    out_vec4_pv_(val, base, wid, vwid, context);
 	    return;
       }
 
@@ -1720,10 +1911,10 @@ inline void vvp_net_t::send_vec4_pv(const vvp_vector4_t&val,
 	  case vvp_net_fil_t::STOP:
 	    break;
 	  case vvp_net_fil_t::PROP:
-	    vvp_send_vec4_pv(out_, val, base, wid, vwid, context);
+	    out_vec4_pv_(val, base, wid, vwid, context);
 	    break;
 	  case vvp_net_fil_t::REPL:
-	    vvp_send_vec4_pv(out_, rep, base, wid, vwid, context);
+	    out_vec4_pv_(rep, base, wid, vwid, context);
 	    break;
       }
 }
@@ -1731,7 +1922,7 @@ inline void vvp_net_t::send_vec4_pv(const vvp_vector4_t&val,
 inline void vvp_net_t::send_vec8(const vvp_vector8_t&val)
 {
       if (fil == 0) {
-	    vvp_send_vec8(out_, val);
+	    out_vec8_(val);
 	    return;
       }
 
@@ -1740,10 +1931,10 @@ inline void vvp_net_t::send_vec8(const vvp_vector8_t&val)
 	  case vvp_net_fil_t::STOP:
 	    break;
 	  case vvp_net_fil_t::PROP:
-	    vvp_send_vec8(out_, val);
+	    out_vec8_(val);
 	    break;
 	  case vvp_net_fil_t::REPL:
-	    vvp_send_vec8(out_, rep);
+	    out_vec8_(rep);
 	    break;
       }
 }
@@ -1775,7 +1966,7 @@ inline void vvp_net_t::send_real(double val, vvp_context_t context)
       if (fil && ! fil->filter_real(val))
 	    return;
 
-      vvp_send_real(out_, val, context);
+      out_real_(val, context);
 }
 
 
@@ -117,6 +117,11 @@ double vvp_signal_value::real_value() const
       return 0;
 }
 
+const vvp_vector4_t*vvp_signal_value::vec4_value_ref() const
+{
+      return 0;
+}
+
 void vvp_net_t::force_vec4(const vvp_vector4_t&val, const vvp_vector2_t&mask)
 {
       assert(fil);
@@ -1044,6 +1049,15 @@ void vvp_wire_vec4::vec4_value(vvp_vector4_t&val) const
 	    val.set_bit(idx, filtered_value_(idx));
 }
 
+const vvp_vector4_t*vvp_wire_vec4::vec4_value_ref() const
+{
+	// If any bits are forced, the value has to be assembled.
+      if (test_force_mask_is_zero())
+	    return &bits4_;
+      else
+	    return 0;
+}
+
 vvp_bit4_t vvp_wire_vec4::driven_value(unsigned idx) const
 {
       return bits4_.value(idx);
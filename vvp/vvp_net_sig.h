@@ -103,6 +103,9 @@ class vvp_signal_value {
       virtual vvp_scalar_t scalar_value(unsigned idx) const =0;
       virtual void vec4_value(vvp_vector4_t&) const =0;
       virtual double real_value() const;
+	// Return the vector that holds the value of the signal, if
+	// there is one, so that it can be read without a copy.
+      virtual const vvp_vector4_t*vec4_value_ref() const;
 
       virtual void get_signal_value(struct t_vpi_value*vp);
 };
@@ -446,6 +449,7 @@ class vvp_wire_vec4 : public vvp_wire_base {
       vvp_bit4_t value(unsigned idx) const;
       vvp_scalar_t scalar_value(unsigned idx) const;
       void vec4_value(vvp_vector4_t&) const;
+      const vvp_vector4_t*vec4_value_ref() const;
 
         // Support for $countdrivers
       vvp_bit4_t driven_value(unsigned idx) const;